@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <new>
+#include <vector>
+#include "Benchmark.h"
+#include "../src/Instrumentation.h"
+
+struct RegisteredBenchmark
+{
+	std::string name;
+	BenchmarkFunction function;
+};
+
+struct RegisteredValidation
+{
+	std::string name;
+	ValidationFunction function;
+};
+
+/*
+The global allocation functions are replaced so every heap allocation made while a benchmark
+runs is counted, including those made inside the standard library. Instrumented builds
+replace them already, so the instrumentation's count is used instead
+*/
+#if INSTRUMENTATION
+long long getAllocationCount()
+{
+	return getInstrumentationTotals().counts[Allocations];
+}
+#else
+static std::atomic<long long> allocationCount{ 0 };
+
+void *operator new(std::size_t size)
+{
+	allocationCount++;
+	void *memory = std::malloc(size == 0 ? 1 : size);
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+// Number of heap allocations made so far
+long long getAllocationCount()
+{
+	return allocationCount;
+}
+#endif
+
+// Function local so registration works regardless of the order static objects are initialised in
+static std::vector<RegisteredBenchmark> &getBenchmarks()
+{
+	static std::vector<RegisteredBenchmark> benchmarks;
+	return benchmarks;
+}
+
+bool registerBenchmark(std::string name, BenchmarkFunction function)
+{
+	getBenchmarks().push_back({ name, function });
+	return true;
+}
+
+static std::vector<RegisteredValidation> &getValidations()
+{
+	static std::vector<RegisteredValidation> validations;
+	return validations;
+}
+
+bool registerValidation(std::string name, ValidationFunction function)
+{
+	getValidations().push_back({ name, function });
+	return true;
+}
+
+// The measurements of one benchmark, per iteration of its fastest timed run
+struct BenchmarkResult
+{
+	std::string name;
+	long long iterations;
+	double nanoseconds;
+	double allocations;
+	double itemsPerSecond;
+	bool skipped;
+};
+
+/*
+Times one benchmark. Runs are repeated with ten times more iterations until one takes at least
+a tenth of a second, then that number of iterations is run again until there have been the
+given number of repetitions, keeping the fastest. A benchmark which skips itself is run once
+*/
+static BenchmarkResult measureBenchmark(const RegisteredBenchmark &benchmark, int repetitions)
+{
+	BenchmarkState state;
+	double seconds = 0;
+	long long allocations = 0;
+	while (true)
+	{
+		state.resetTimer();
+		benchmark.function(state);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - state.startTime;
+		seconds = elapsed.count();
+		allocations = getAllocationCount() - state.startAllocations;
+		if (state.skipped)
+		{
+			return { benchmark.name, 0, 0, 0, 0, true };
+		}
+		if (seconds >= 0.1 || state.iterations >= 1000000000)
+		{
+			break;
+		}
+		state.iterations *= 10;
+	}
+	for (int repetition = 1; repetition < repetitions; repetition++)
+	{
+		state.resetTimer();
+		benchmark.function(state);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - state.startTime;
+		seconds = std::min(seconds, elapsed.count());
+	}
+	double itemsPerSecond = state.itemsPerIteration * state.iterations / seconds;
+	return { benchmark.name, state.iterations, seconds * 1e9 / state.iterations, (double)allocations / state.iterations, itemsPerSecond, false };
+}
+
+/*
+Writes the results as a JSON object holding an array of benchmarks. The names are function
+names so don't need escaping, and items per second is 0 for benchmarks which don't report it
+*/
+static bool writeResults(std::string path, const std::vector<BenchmarkResult> &results)
+{
+	FILE *file = std::fopen(path.c_str(), "w");
+	if (!file)
+	{
+		return false;
+	}
+	std::fprintf(file, "{\n\t\"benchmarks\": [\n");
+	for (int i = 0; i < (int)results.size(); i++)
+	{
+		const BenchmarkResult &result = results[i];
+		std::fprintf(file, "\t\t{ \"name\": \"%s\", \"iterations\": %lld, \"nsPerIteration\": %.1f, \"allocationsPerIteration\": %.2f, \"itemsPerSecond\": %.6g }%s\n",
+			result.name.c_str(), result.iterations, result.nanoseconds, result.allocations, result.itemsPerSecond,
+			i + 1 < (int)results.size() ? "," : "");
+	}
+	std::fprintf(file, "\t]\n}\n");
+	return std::fclose(file) == 0;
+}
+
+/*
+Reads the time per iteration of each benchmark from results written by writeResults. Only the
+"name" and "nsPerIteration" members of each benchmark are looked for, so a baseline edited by
+hand or written by an older harness with more or fewer members still reads
+*/
+static bool readBaseline(std::string path, std::map<std::string, double> &baseline)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+	std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	size_t position = 0;
+	while ((position = text.find("\"name\"", position)) != std::string::npos)
+	{
+		size_t nameStart = text.find('"', text.find(':', position));
+		size_t nameEnd = text.find('"', nameStart + 1);
+		size_t timeKey = text.find("\"nsPerIteration\"", nameEnd);
+		if (nameStart == std::string::npos || nameEnd == std::string::npos || timeKey == std::string::npos)
+		{
+			return false;
+		}
+		size_t timeStart = text.find(':', timeKey);
+		char *timeEnd;
+		double nanoseconds = std::strtod(text.c_str() + timeStart + 1, &timeEnd);
+		if (timeEnd == text.c_str() + timeStart + 1)
+		{
+			return false;
+		}
+		baseline[text.substr(nameStart + 1, nameEnd - nameStart - 1)] = nanoseconds;
+		position = timeEnd - text.c_str();
+	}
+	return true;
+}
+
+/*
+Runs every benchmark whose name contains the filter and prints the time, allocations and
+throughput per iteration, along with the change in time from the baseline if one is given.
+Skipped benchmarks are listed as skipped and left out of the results and the comparison.
+Returns 1 if the baseline can't be read, the results can't be written or any benchmark has
+regressed and 0 otherwise
+*/
+int runBenchmarks(const BenchmarkOptions &options)
+{
+	std::map<std::string, double> baseline;
+	bool hasBaseline = !options.baselinePath.empty();
+	if (hasBaseline && !readBaseline(options.baselinePath, baseline))
+	{
+		std::fprintf(stderr, "Couldn't read the baseline %s\n", options.baselinePath.c_str());
+		return 1;
+	}
+	std::vector<RegisteredBenchmark> benchmarks = getBenchmarks();
+	std::sort(benchmarks.begin(), benchmarks.end(), [](const RegisteredBenchmark &benchmark1, const RegisteredBenchmark &benchmark2)
+	{
+		return benchmark1.name < benchmark2.name;
+	});
+	std::printf("%-40s %12s %14s %14s %16s%s\n", "Benchmark", "Iterations", "ns/iteration", "allocs/iter", "items/s",
+		hasBaseline ? "   vs baseline" : "");
+	std::vector<BenchmarkResult> results;
+	std::vector<std::string> regressions;
+	for (const RegisteredBenchmark &benchmark : benchmarks)
+	{
+		if (benchmark.name.find(options.filter) == std::string::npos)
+		{
+			continue;
+		}
+		BenchmarkResult result = measureBenchmark(benchmark, std::max(options.repetitions, 1));
+		if (result.skipped)
+		{
+			std::printf("%-40s %12s\n", result.name.c_str(), "skipped");
+			std::fflush(stdout);
+			continue;
+		}
+		results.push_back(result);
+		std::printf("%-40s %12lld %14.1f %14.2f", result.name.c_str(), result.iterations, result.nanoseconds, result.allocations);
+		if (result.itemsPerSecond > 0)
+		{
+			std::printf(" %16.4g", result.itemsPerSecond);
+		}
+		else
+		{
+			std::printf(" %16s", "-");
+		}
+		std::map<std::string, double>::const_iterator baselineTime = baseline.find(result.name);
+		if (baselineTime != baseline.end() && baselineTime->second > 0)
+		{
+			double change = (result.nanoseconds / baselineTime->second - 1) * 100;
+			bool regressed = change > options.regressionThreshold;
+			std::printf(" %+13.1f%%%s", change, regressed ? "  regressed" : "");
+			if (regressed)
+			{
+				regressions.push_back(result.name);
+			}
+		}
+		else if (hasBaseline)
+		{
+			std::printf(" %14s", "new");
+		}
+		std::printf("\n");
+		std::fflush(stdout);
+	}
+	if (!options.jsonPath.empty() && !writeResults(options.jsonPath, results))
+	{
+		std::fprintf(stderr, "Couldn't write the results to %s\n", options.jsonPath.c_str());
+		return 1;
+	}
+	if (!regressions.empty())
+	{
+		std::printf("%d benchmarks are more than %g%% slower than the baseline:", (int)regressions.size(), options.regressionThreshold);
+		for (const std::string &name : regressions)
+		{
+			std::printf(" %s", name.c_str());
+		}
+		std::printf("\n");
+		return 1;
+	}
+	return 0;
+}
+
+/*
+Runs every validation whose name contains the filter, printing whether each passed. Returns 1
+if any failed or none matched the filter and 0 otherwise
+*/
+int runValidations(std::string filter)
+{
+	std::vector<RegisteredValidation> validations = getValidations();
+	std::sort(validations.begin(), validations.end(), [](const RegisteredValidation &validation1, const RegisteredValidation &validation2)
+	{
+		return validation1.name < validation2.name;
+	});
+	int numberRun = 0;
+	int numberFailed = 0;
+	for (const RegisteredValidation &validation : validations)
+	{
+		if (validation.name.find(filter) == std::string::npos)
+		{
+			continue;
+		}
+		bool passed = validation.function();
+		std::printf("%-40s %s\n", validation.name.c_str(), passed ? "passed" : "FAILED");
+		std::fflush(stdout);
+		numberRun++;
+		numberFailed += !passed;
+	}
+	if (numberRun == 0)
+	{
+		std::fprintf(stderr, "No validation matches %s\n", filter.c_str());
+		return 1;
+	}
+	return numberFailed > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#include <chrono>
+#include <string>
+
+long long getAllocationCount();
+
+/*
+A small self contained benchmark harness. A benchmark is a function which runs the code being
+measured state.iterations times. The runner raises the number of iterations until a run takes
+long enough to time reliably and counts the heap allocations made during the timed run.
+Benchmarks with expensive setup call resetTimer once it is done so it isn't measured, and
+benchmarks which can't run on this machine, such as those of kernels the CPU doesn't support,
+set skipped and return
+*/
+struct BenchmarkState
+{
+	long long iterations = 1;
+	// Set by benchmarks which process a number of items per iteration to report a throughput
+	double itemsPerIteration = 0;
+	bool skipped = false;
+	std::chrono::steady_clock::time_point startTime;
+	long long startAllocations = 0;
+
+	void resetTimer()
+	{
+		startTime = std::chrono::steady_clock::now();
+		startAllocations = getAllocationCount();
+	}
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkState&);
+
+bool registerBenchmark(std::string, BenchmarkFunction);
+
+#define BENCHMARK(function) static bool function##Registered = registerBenchmark(#function, function)
+
+/*
+A validation checks that an optimised piece of code gives the same results as the code it
+replaced, printing what differs and returning false if anything does. Validations are run on
+their own, as the tests, rather than as part of any benchmark
+*/
+typedef bool (*ValidationFunction)();
+
+bool registerValidation(std::string, ValidationFunction);
+
+#define VALIDATION(function) static bool function##Registered = registerValidation(#function, function)
+
+/*
+Which benchmarks to run and what to do with the results. Each benchmark's timed run is repeated
+and the fastest kept, to be less sensitive to noise. The results can be written to a JSON file
+and compared with a baseline written in the same way, in which case a benchmark that has become
+slower by more than the threshold (in percent) is reported as a regression
+*/
+struct BenchmarkOptions
+{
+	std::string filter;
+	int repetitions = 1;
+	std::string jsonPath;
+	std::string baselinePath;
+	double regressionThreshold = 5;
+};
+
+int runBenchmarks(const BenchmarkOptions&);
+
+int runValidations(std::string);
+
+// Stops the compiler from optimising away a result which is never used
+template<typename T>
+void doNotOptimise(const T &value)
+{
+#if defined(__GNUC__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void *sink;
+	sink = &value;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "Benchmark.h"
+#include "../src/Diversity.h"
+#include "../src/Network.h"
+#include "../src/Population.h"
+
+// Random genomes for a population of the given size
+static Population makePopulation(int numberAgents)
+{
+	Population population(numberAgents, getAgentNetworkArchitecture());
+	Random random(1);
+	for (int agent = 0; agent < numberAgents; agent++)
+	{
+		float *genome = population.getGenome(agent);
+		for (int weight = 0; weight < population.numberWeights; weight++)
+		{
+			genome[weight] = random.nextFloat() * 2 - 1;
+		}
+	}
+	return population;
+}
+
+/*
+Compares the exact mean distance with the distance between every pair of agents worked out
+one pair at a time, the sampled mean distance of two agents with the distance between them
+(which it only matches if no agent is paired with itself) and each diversity kernel the CPU
+supports with the scalar one
+*/
+static bool diversity()
+{
+	ThreadPool threadPool(1);
+	Population population = makePopulation(300);
+	bool valid = true;
+	double totalDistance = 0;
+	for (int agent1 = 0; agent1 < population.size(); agent1++)
+	{
+		for (int agent2 = agent1 + 1; agent2 < population.size(); agent2++)
+		{
+			totalDistance += geneticDiversity(ScalarGenetics, population.getGenome(agent1), population.getGenome(agent2), population.numberWeights);
+		}
+	}
+	double expected = totalDistance / ((double)population.size() * (population.size() - 1) / 2);
+	DiversityMeter meter;
+	Random random;
+	double exact = meter.measure(ExactDiversity, ScalarGenetics, population.getGenome(0), population.genomeStride, population.numberWeights,
+		population.size(), random, threadPool).meanDistance;
+	if (std::abs(exact - expected) > 1e-9 * expected)
+	{
+		std::printf("The exact diversity is %.9g but the mean over every pair is %.9g\n", exact, expected);
+		valid = false;
+	}
+	double sampled = meter.measure(SampledDiversity, ScalarGenetics, population.getGenome(0), population.genomeStride, population.numberWeights,
+		2, random, threadPool).meanDistance;
+	double pairDistance = geneticDiversity(ScalarGenetics, population.getGenome(0), population.getGenome(1), population.numberWeights);
+	if (std::abs(sampled - pairDistance) > 1e-6 * pairDistance)
+	{
+		std::printf("The sampled diversity of two agents is %.9g but the distance between them is %.9g\n", sampled, pairDistance);
+		valid = false;
+	}
+	for (GeneticsKernel kernel : { Avx2Genetics, Avx512Genetics })
+	{
+		if (!isGeneticsKernelSupported(kernel))
+		{
+			continue;
+		}
+		int mismatches = 0;
+		for (int agent = 1; agent < population.size(); agent++)
+		{
+			for (int numberWeights = 0; numberWeights <= population.numberWeights; numberWeights += 7)
+			{
+				mismatches += geneticDiversity(kernel, population.getGenome(0), population.getGenome(agent), numberWeights)
+					!= geneticDiversity(ScalarGenetics, population.getGenome(0), population.getGenome(agent), numberWeights);
+			}
+		}
+		if (mismatches != 0)
+		{
+			std::printf("The %s diversity kernel disagrees with the scalar kernel %d times\n", getGeneticsKernelName(kernel), mismatches);
+			valid = false;
+		}
+	}
+	return valid;
+}
+VALIDATION(diversity);
+
+// Measures a population's diversity, reporting the throughput in agents per second
+static void runDiversity(BenchmarkState &state, int numberAgents, DiversityMode mode)
+{
+	ThreadPool threadPool(1);
+	Population population = makePopulation(numberAgents);
+	DiversityMeter meter;
+	Random random(2);
+	meter.measure(mode, bestGeneticsKernel(), population.getGenome(0), population.genomeStride, population.numberWeights, numberAgents, random, threadPool);
+	state.itemsPerIteration = numberAgents;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		DiversityStatistics statistics = meter.measure(mode, bestGeneticsKernel(), population.getGenome(0), population.genomeStride,
+			population.numberWeights, numberAgents, random, threadPool);
+		doNotOptimise(statistics.meanDistance);
+	}
+}
+
+#define DIVERSITY_BENCHMARK(name, numberAgents, mode) \
+	static void name(BenchmarkState &state) \
+	{ \
+		runDiversity(state, numberAgents, mode); \
+	} \
+	BENCHMARK(name)
+
+DIVERSITY_BENCHMARK(diversityExact1k, 1000, ExactDiversity);
+DIVERSITY_BENCHMARK(diversitySampled1k, 1000, SampledDiversity);
+DIVERSITY_BENCHMARK(diversityExact100k, 100000, ExactDiversity);
+DIVERSITY_BENCHMARK(diversitySampled100k, 100000, SampledDiversity);
+DIVERSITY_BENCHMARK(diversityExact1M, 1000000, ExactDiversity);
+DIVERSITY_BENCHMARK(diversitySampled1M, 1000000, SampledDiversity);
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Benchmark.h"
+#include "../src/Genetics.h"
+#include "../src/Network.h"
+#include "../src/Population.h"
+
+// A generation's worth of children for a population of around five thousand agents
+static const int numberChildren = 4096;
+static const int numberParents = 512;
+
+// Breeds a batch of children from random parents with the given kernel, as the genetic algorithm does
+static void breedChildren(GeneticsKernel kernel, const std::vector<float> &parents, const std::vector<int> &couples, std::vector<float> &children,
+	int genomeStride, const std::vector<int> &networkArchitecture, int numberWeights, CrossoverType crossover, MutationType mutation, Random &random)
+{
+	crossBatch(kernel, parents.data(), couples.data(), numberChildren, children.data(), genomeStride, networkArchitecture, crossover, random);
+	mutateBatch(kernel, children.data(), numberChildren, genomeStride, numberWeights, 10, mutation, random);
+}
+
+// Random parents for a population's genomes and random couples of them
+static void makeParents(const Population &population, std::vector<float> &parents, std::vector<int> &couples)
+{
+	Random random(1);
+	parents.assign((size_t)numberParents * population.genomeStride, 0);
+	for (int parent = 0; parent < numberParents; parent++)
+	{
+		for (int weight = 0; weight < population.numberWeights; weight++)
+		{
+			parents[(size_t)parent * population.genomeStride + weight] = random.nextFloat() * 2 - 1;
+		}
+	}
+	couples.resize(2 * numberChildren);
+	for (int &parent : couples)
+	{
+		parent = random.nextInt(numberParents);
+	}
+}
+
+/*
+Compares each kernel the CPU supports with the scalar one by breeding the same children from
+the same seed with every kind of crossover and mutation, which must give identical genomes
+*/
+static bool geneticsKernels()
+{
+	std::vector<int> networkArchitecture = getAgentNetworkArchitecture();
+	Population population(numberParents, networkArchitecture);
+	std::vector<float> parents;
+	std::vector<int> couples;
+	makeParents(population, parents, couples);
+	std::vector<float> children((size_t)numberChildren * population.genomeStride);
+	std::vector<float> expected(children.size());
+	bool valid = true;
+	for (GeneticsKernel kernel : { Avx2Genetics, Avx512Genetics })
+	{
+		if (!isGeneticsKernelSupported(kernel))
+		{
+			continue;
+		}
+		int mismatches = 0;
+		for (CrossoverType crossover : { LayerCrossover, SinglePointCrossover, UniformCrossover })
+		{
+			for (MutationType mutation : { SoftMutation, HardMutation, GaussianMutation })
+			{
+				Random random(crossover * 3 + mutation);
+				Random expectedRandom(crossover * 3 + mutation);
+				breedChildren(kernel, parents, couples, children, population.genomeStride, networkArchitecture, population.numberWeights,
+					crossover, mutation, random);
+				breedChildren(ScalarGenetics, parents, couples, expected, population.genomeStride, networkArchitecture, population.numberWeights,
+					crossover, mutation, expectedRandom);
+				mismatches += std::memcmp(children.data(), expected.data(), children.size() * sizeof(float)) != 0;
+			}
+		}
+		if (mismatches != 0)
+		{
+			std::printf("The %s genetics kernel disagrees with the scalar kernel for %d operators\n", getGeneticsKernelName(kernel), mismatches);
+			valid = false;
+		}
+	}
+	return valid;
+}
+VALIDATION(geneticsKernels);
+
+// Crosses and mutates a batch of children, reporting the throughput in weights bred per second
+static void runBreeding(BenchmarkState &state, GeneticsKernel kernel, CrossoverType crossover, MutationType mutation)
+{
+	if (!isGeneticsKernelSupported(kernel))
+	{
+		state.skipped = true;
+		return;
+	}
+	std::vector<int> networkArchitecture = getAgentNetworkArchitecture();
+	Population population(numberParents, networkArchitecture);
+	std::vector<float> parents;
+	std::vector<int> couples;
+	makeParents(population, parents, couples);
+	Random random(1);
+	std::vector<float> children((size_t)numberChildren * population.genomeStride);
+	state.itemsPerIteration = (double)numberChildren * population.numberWeights;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		breedChildren(kernel, parents, couples, children, population.genomeStride, networkArchitecture, population.numberWeights, crossover, mutation, random);
+		doNotOptimise(children[0]);
+	}
+}
+
+#define BREEDING_BENCHMARK(name, kernel, crossover, mutation) \
+	static void name(BenchmarkState &state) \
+	{ \
+		runBreeding(state, kernel, crossover, mutation); \
+	} \
+	BENCHMARK(name)
+
+BREEDING_BENCHMARK(breedLayerHardScalar, ScalarGenetics, LayerCrossover, HardMutation);
+BREEDING_BENCHMARK(breedLayerHardAvx2, Avx2Genetics, LayerCrossover, HardMutation);
+BREEDING_BENCHMARK(breedLayerHardAvx512, Avx512Genetics, LayerCrossover, HardMutation);
+BREEDING_BENCHMARK(breedUniformSoftScalar, ScalarGenetics, UniformCrossover, SoftMutation);
+BREEDING_BENCHMARK(breedUniformSoftAvx2, Avx2Genetics, UniformCrossover, SoftMutation);
+BREEDING_BENCHMARK(breedUniformSoftAvx512, Avx512Genetics, UniformCrossover, SoftMutation);
+BREEDING_BENCHMARK(breedSinglePointGaussianScalar, ScalarGenetics, SinglePointCrossover, GaussianMutation);
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include <cstdio>
+#include <random>
+#include "Benchmark.h"
+#include "../src/Intersection.h"
+
+static const int segmentsPerRay = 4096;
+static const int numberRays = 64;
+
+/*
+Random segments in a 1000 by 1000 square. Some share end points with the rays or are
+parallel to them so the edge cases of the intersection test are exercised as well
+*/
+static SegmentArrays makeSegmentArrays(const std::vector<Segment> &rays)
+{
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<float> position(0, 1000);
+	std::uniform_real_distribution<float> offset(-100, 100);
+	SegmentArrays segments;
+	for (int i = 0; i < segmentsPerRay; i++)
+	{
+		Vector2 start = { position(generator), position(generator) };
+		Vector2 end = { start.x + offset(generator), start.y + offset(generator) };
+		const Segment &ray = rays[i % rays.size()];
+		if (i % 7 == 0)
+		{
+			start = ray.start;
+		}
+		else if (i % 11 == 0)
+		{
+			end = { start.x + ray.end.x - ray.start.x, start.y + ray.end.y - ray.start.y };
+		}
+		segments.append({ start, end });
+	}
+	return segments;
+}
+
+static std::vector<Segment> makeRays()
+{
+	std::mt19937 generator(2);
+	std::uniform_real_distribution<float> position(0, 1000);
+	std::uniform_real_distribution<float> offset(-30, 30);
+	std::vector<Segment> rays;
+	for (int i = 0; i < numberRays; i++)
+	{
+		Vector2 start = { position(generator), position(generator) };
+		rays.push_back({ start, { start.x + offset(generator), start.y + offset(generator) } });
+	}
+	return rays;
+}
+
+/*
+Compares each kernel the CPU supports with the scalar one over every ray and every range of
+segments up to 40 long from each start, which covers every length of tail a vector can be
+left with
+*/
+static bool intersectionKernels()
+{
+	std::vector<Segment> rays = makeRays();
+	SegmentArrays segments = makeSegmentArrays(rays);
+	bool valid = true;
+	for (IntersectionKernel kernel : { Avx2Intersection, Avx512Intersection })
+	{
+		if (!isIntersectionKernelSupported(kernel))
+		{
+			continue;
+		}
+		int mismatches = 0;
+		for (const Segment &ray : rays)
+		{
+			for (int begin = 0; begin < 200; begin++)
+			{
+				for (int end = begin; end <= begin + 40; end++)
+				{
+					float nearest = nearestIntersection(kernel, segments, begin, end, ray.start, ray.end, 1e30f, 100);
+					float expected = nearestIntersection(ScalarIntersection, segments, begin, end, ray.start, ray.end, 1e30f, 100);
+					bool any = anyIntersection(kernel, segments, begin, end, ray.start, ray.end);
+					bool expectedAny = anyIntersection(ScalarIntersection, segments, begin, end, ray.start, ray.end);
+					mismatches += nearest != expected || any != expectedAny;
+				}
+			}
+		}
+		if (mismatches != 0)
+		{
+			std::printf("The %s intersection kernel disagrees with the scalar kernel %d times\n", getIntersectionKernelName(kernel), mismatches);
+			valid = false;
+		}
+	}
+	return valid;
+}
+VALIDATION(intersectionKernels);
+
+// Tests each ray against every segment, reporting the throughput in segments tested per second
+static void runIntersection(BenchmarkState &state, IntersectionKernel kernel, bool collision)
+{
+	if (!isIntersectionKernelSupported(kernel))
+	{
+		state.skipped = true;
+		return;
+	}
+	std::vector<Segment> rays = makeRays();
+	SegmentArrays segments = makeSegmentArrays(rays);
+	state.itemsPerIteration = (double)segmentsPerRay * numberRays;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		float total = 0;
+		for (const Segment &ray : rays)
+		{
+			if (collision)
+			{
+				// Tests in slices as the test stops at the first hit
+				for (int begin = 0; begin < segmentsPerRay; begin += 32)
+				{
+					total += anyIntersection(kernel, segments, begin, begin + 32, ray.start, ray.end);
+				}
+			}
+			else
+			{
+				total += nearestIntersection(kernel, segments, 0, segmentsPerRay, ray.start, ray.end, 1e30f, 100);
+			}
+		}
+		doNotOptimise(total);
+	}
+}
+
+#define INTERSECTION_BENCHMARK(name, kernel, collision) \
+	static void name(BenchmarkState &state) \
+	{ \
+		runIntersection(state, kernel, collision); \
+	} \
+	BENCHMARK(name)
+
+INTERSECTION_BENCHMARK(nearestIntersectionScalar, ScalarIntersection, false);
+INTERSECTION_BENCHMARK(nearestIntersectionAvx2, Avx2Intersection, false);
+INTERSECTION_BENCHMARK(nearestIntersectionAvx512, Avx512Intersection, false);
+INTERSECTION_BENCHMARK(anyIntersectionScalar, ScalarIntersection, true);
+INTERSECTION_BENCHMARK(anyIntersectionAvx2, Avx2Intersection, true);
+INTERSECTION_BENCHMARK(anyIntersectionAvx512, Avx512Intersection, true);
+
+
+/*
+Tests each ray against every segment one pair at a time with checkIntersection, either from
+the segment's end points as the original code did or from the segment prepared ahead of time
+*/
+static void runCheckIntersection(BenchmarkState &state, bool prepared)
+{
+	std::vector<Segment> rays = makeRays();
+	SegmentArrays segments = makeSegmentArrays(rays);
+	std::vector<Segment> endPoints;
+	for (int i = 0; i < segments.size(); i++)
+	{
+		PreparedSegment segment = segments.get(i);
+		// A prepared segment's delta is its start minus its end
+		endPoints.push_back({ segment.start, { segment.start.x - segment.delta.x, segment.start.y - segment.delta.y } });
+	}
+	state.itemsPerIteration = (double)segmentsPerRay * numberRays;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		int hits = 0;
+		for (const Segment &ray : rays)
+		{
+			for (int j = 0; j < segmentsPerRay; j++)
+			{
+				intersectionPoint point = prepared ? checkIntersection(segments.get(j), ray.start, ray.end)
+					: checkIntersection(endPoints[j].start, endPoints[j].end, ray.start, ray.end);
+				hits += point.lambda >= 0 && point.lambda <= 1 && point.mu >= 0 && point.mu <= 1;
+			}
+		}
+		doNotOptimise(hits);
+	}
+}
+
+static void checkIntersectionEndPoints(BenchmarkState &state)
+{
+	runCheckIntersection(state, false);
+}
+BENCHMARK(checkIntersectionEndPoints);
+
+static void checkIntersectionPrepared(BenchmarkState &state)
+{
+	runCheckIntersection(state, true);
+}
+BENCHMARK(checkIntersectionPrepared);
\ No newline at end of file
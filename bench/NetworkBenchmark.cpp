@@ -0,0 +1,230 @@
+#include <cstdio>
+#include <cstdlib>
+#include "Benchmark.h"
+#include "../src/Agent.h"
+#include "../src/FixedMatrix.h"
+#include "../src/Matrix.h"
+#include "../src/Network.h"
+#include "../src/Random.h"
+#include "../src/Track.h"
+
+static const int batchSize = 4096;
+
+// A population of agents with random genomes placed at the start of the map
+static Population makePopulation(const Track &track, int numberAgents)
+{
+	Population population(numberAgents, getAgentNetworkArchitecture());
+	Random random;
+	for (int agent = 0; agent < numberAgents; agent++)
+	{
+		population.resetAgent(agent, track.getStartingPosition(), track.getStartingAngle());
+		float *genome = population.getGenome(agent);
+		for (int weight = 0; weight < population.numberWeights; weight++)
+		{
+			genome[weight] = random.nextFloat() * 2 - 1;
+		}
+	}
+	return population;
+}
+
+static const Track &getTrack()
+{
+	static std::shared_ptr<const Track> track;
+	if (!track)
+	{
+		std::string error;
+		track = Track::load("resources/map.txt", error);
+		if (!track)
+		{
+			std::printf("%s\n", error.c_str());
+			std::exit(1);
+		}
+	}
+	return *track;
+}
+
+static void matrixMultiply(BenchmarkState &state)
+{
+	Matrix input(1, 3, { 0.5f, 0.25f, 1.0f });
+	Matrix weights(3, 5, std::vector<float>(15, 0.1f));
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		Matrix output = input * weights;
+		doNotOptimise(output);
+	}
+}
+BENCHMARK(matrixMultiply);
+
+static void fixedMatrixMultiply(BenchmarkState &state)
+{
+	float inputData[3] = { 0.5f, 0.25f, 1.0f };
+	float weightData[15] = { 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f };
+	FixedMatrix<1, 3> input(inputData);
+	FixedMatrix<3, 5> weights(weightData);
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		doNotOptimise(input);
+		FixedMatrix<1, 5> output = input * weights;
+		doNotOptimise(output);
+	}
+}
+BENCHMARK(fixedMatrixMultiply);
+
+// A single agent tick with its network evaluated through Matrix objects, as updateAgent used to
+static void updateAgentReference(BenchmarkState &state)
+{
+	Population population = makePopulation(getTrack(), 1);
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		// The agent is put back at the start regularly so it stays inside the map
+		if (i % 100 == 0)
+		{
+			population.resetAgent(0, getTrack().getStartingPosition(), getTrack().getStartingAngle());
+		}
+		float inputDistances[3];
+		senseAgent(population, 0, getTrack().getWalls(), inputDistances, 1);
+		moveAgent(population, 0, decideReference(inputDistances, 1, population.getGenome(0), population.networkArchitecture));
+	}
+	doNotOptimise(population.positionX[0]);
+}
+BENCHMARK(updateAgentReference);
+
+static void updateAgentFixed(BenchmarkState &state)
+{
+	Population population = makePopulation(getTrack(), 1);
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		if (i % 100 == 0)
+		{
+			population.resetAgent(0, getTrack().getStartingPosition(), getTrack().getStartingAngle());
+		}
+		updateAgent(population, 0, getTrack().getWalls());
+	}
+	doNotOptimise(population.positionX[0]);
+}
+BENCHMARK(updateAgentFixed);
+
+/*
+Tests the body of an agent against the walls, from the start of the map where it doesn't
+touch one, which is the test nearly every tick of a run makes
+*/
+static void checkAgentFailStart(BenchmarkState &state)
+{
+	Population population = makePopulation(getTrack(), 1);
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		doNotOptimise(checkAgentFail(population, 0, getTrack().getWalls()));
+	}
+}
+BENCHMARK(checkAgentFailStart);
+
+// Tests the body of an agent at the start of the map against the first check point
+static void updateAgentFitnessStart(BenchmarkState &state)
+{
+	Population population = makePopulation(getTrack(), 1);
+	const Segment &checkPoint = getTrack().getCheckPoints()[0];
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		doNotOptimise(updateAgentFitness(population, 0, checkPoint.start, checkPoint.end, 0));
+	}
+	doNotOptimise(population.fitness[0]);
+}
+BENCHMARK(updateAgentFitnessStart);
+
+/*
+Compares the decisions of each supported batched kernel with decideReference for random
+genomes and sensor distances, with every batch size up to 40 from several starting agents so
+every length of tail a vector can be left with is covered
+*/
+static bool networkKernels()
+{
+	const int numberAgents = 64;
+	Population population = makePopulation(getTrack(), numberAgents);
+	std::vector<float> inputs(3 * numberAgents);
+	Random random(2);
+	for (float &input : inputs)
+	{
+		input = random.nextFloat() * 100;
+	}
+	std::vector<char> decisions(numberAgents);
+	bool valid = true;
+	for (NetworkKernel kernel : { ReferenceKernel, ScalarKernel, Avx2Kernel, Avx512Kernel })
+	{
+		if (!isNetworkKernelSupported(kernel))
+		{
+			continue;
+		}
+		int mismatches = 0;
+		for (int begin = 0; begin < 4; begin++)
+		{
+			for (int count = 1; count <= 40; count++)
+			{
+				forwardBatch(kernel, inputs.data() + begin, numberAgents, population.getGenome(begin), population.genomeStride,
+					population.networkArchitecture, count, decisions.data());
+				for (int agent = 0; agent < count; agent++)
+				{
+					mismatches += (bool)decisions[agent] != decideReference(inputs.data() + begin + agent, numberAgents,
+						population.getGenome(begin + agent), population.networkArchitecture);
+				}
+			}
+		}
+		if (mismatches != 0)
+		{
+			std::printf("The %s network kernel disagrees with the reference decisions %d times\n", getNetworkKernelName(kernel), mismatches);
+			valid = false;
+		}
+	}
+	return valid;
+}
+VALIDATION(networkKernels);
+
+// Evaluates the networks of a batch of agents with the given kernel
+static void runForwardBatch(BenchmarkState &state, NetworkKernel kernel)
+{
+	if (!isNetworkKernelSupported(kernel))
+	{
+		state.skipped = true;
+		return;
+	}
+	Population population = makePopulation(getTrack(), batchSize);
+	std::vector<float> inputs(3 * batchSize);
+	Random random(1);
+	random.fillFloats(inputs.data(), inputs.size());
+	std::vector<char> decisions(batchSize);
+	state.itemsPerIteration = batchSize;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		forwardBatch(kernel, inputs.data(), batchSize, population.getGenome(0), population.genomeStride,
+			population.networkArchitecture, batchSize, decisions.data());
+		doNotOptimise(decisions[0]);
+	}
+}
+
+static void forwardBatchReference(BenchmarkState &state)
+{
+	runForwardBatch(state, ReferenceKernel);
+}
+BENCHMARK(forwardBatchReference);
+
+static void forwardBatchScalar(BenchmarkState &state)
+{
+	runForwardBatch(state, ScalarKernel);
+}
+BENCHMARK(forwardBatchScalar);
+
+static void forwardBatchAvx2(BenchmarkState &state)
+{
+	runForwardBatch(state, Avx2Kernel);
+}
+BENCHMARK(forwardBatchAvx2);
+
+static void forwardBatchAvx512(BenchmarkState &state)
+{
+	runForwardBatch(state, Avx512Kernel);
+}
+BENCHMARK(forwardBatchAvx512);
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include <cstdlib>
+#include <vector>
+#include "Benchmark.h"
+#include "../src/Random.h"
+
+static const int numbersPerIteration = 4096;
+
+// The C library generator the genetic algorithm used to draw from, for comparison
+static void randomRand(BenchmarkState &state)
+{
+	srand(0);
+	state.itemsPerIteration = numbersPerIteration;
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		float total = 0;
+		for (int j = 0; j < numbersPerIteration; j++)
+		{
+			total += (float)rand() / RAND_MAX;
+		}
+		doNotOptimise(total);
+	}
+}
+BENCHMARK(randomRand);
+
+static void randomNextFloat(BenchmarkState &state)
+{
+	Random random;
+	state.itemsPerIteration = numbersPerIteration;
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		float total = 0;
+		for (int j = 0; j < numbersPerIteration; j++)
+		{
+			total += random.nextFloat();
+		}
+		doNotOptimise(total);
+	}
+}
+BENCHMARK(randomNextFloat);
+
+static void randomFillFloats(BenchmarkState &state)
+{
+	Random random;
+	std::vector<float> values(numbersPerIteration);
+	state.itemsPerIteration = numbersPerIteration;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		random.fillFloats(values.data(), numbersPerIteration);
+		doNotOptimise(values[0]);
+	}
+}
+BENCHMARK(randomFillFloats);
\ No newline at end of file
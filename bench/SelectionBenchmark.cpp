@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <vector>
+#include "Benchmark.h"
+#include "../src/Selection.h"
+
+/*
+Fitnesses spread like a generation's, mostly low with a long tail of agents which got
+further, and with plenty of ties as fitness is compared as a whole number
+*/
+static std::vector<float> makeFitnesses(int numberAgents)
+{
+	Random random(1);
+	std::vector<float> fitnesses(numberAgents);
+	for (float &fitness : fitnesses)
+	{
+		float progress = random.nextFloat();
+		fitness = 1 + 10000 * progress * progress * progress;
+	}
+	return fitnesses;
+}
+
+// Every agent's index, fittest first with ties broken by index as selection ranks them
+static std::vector<int> sortAgents(const std::vector<float> &fitnesses)
+{
+	std::vector<int> ranking(fitnesses.size());
+	std::iota(ranking.begin(), ranking.end(), 0);
+	std::sort(ranking.begin(), ranking.end(), [&fitnesses](int agent1, int agent2)
+	{
+		return (int)fitnesses[agent1] > (int)fitnesses[agent2] || ((int)fitnesses[agent1] == (int)fitnesses[agent2] && agent1 < agent2);
+	});
+	return ranking;
+}
+
+/*
+Checks a sampling strategy picks every agent within one of the number of times its weight
+gives it, where weights[a] is the weight of agent a
+*/
+static bool isSampledEvenly(SelectionStrategy strategy, const std::vector<float> &fitnesses, const std::vector<double> &weights, int numberParents,
+	Random &random)
+{
+	std::vector<RankedAgent> ranked;
+	std::vector<int> parents(numberParents);
+	selectParents(strategy, fitnesses.data(), fitnesses.size(), numberParents, random, ranked, parents.data());
+	std::vector<int> counts(fitnesses.size());
+	for (int parent : parents)
+	{
+		if (parent < 0 || parent >= (int)fitnesses.size())
+		{
+			std::printf("%s selection picked agent %d of %d\n", getSelectionStrategyName(strategy), parent, (int)fitnesses.size());
+			return false;
+		}
+		counts[parent]++;
+	}
+	double totalWeight = std::accumulate(weights.begin(), weights.end(), 0.0);
+	for (int agent = 0; agent < (int)fitnesses.size(); agent++)
+	{
+		double expected = numberParents * weights[agent] / totalWeight;
+		if (std::abs(counts[agent] - expected) > 1 + 1e-6)
+		{
+			std::printf("%s selection picked agent %d %d times rather than about %g\n", getSelectionStrategyName(strategy), agent, counts[agent], expected);
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+Checks the fittest agents and truncation pick the same agents as a full sort, rank selection
+and stochastic universal sampling pick each agent within one of its expected number of times
+(also when every fitness is zero) and tournaments only pick agents which exist
+*/
+static bool selection()
+{
+	const int numberAgents = 1000;
+	std::vector<float> fitnesses = makeFitnesses(numberAgents);
+	std::vector<int> ranking = sortAgents(fitnesses);
+	std::vector<RankedAgent> ranked;
+	std::vector<int> elite(numberAgents / 10);
+	selectFittest(fitnesses.data(), numberAgents, elite.size(), ranked, elite.data());
+	if (!std::equal(elite.begin(), elite.end(), ranking.begin()))
+	{
+		std::printf("The fittest agents differ from those of a full sort\n");
+		return false;
+	}
+	std::vector<int> parents(numberAgents / 5);
+	Random random(3);
+	selectParents(TruncationSelection, fitnesses.data(), numberAgents, parents.size(), random, ranked, parents.data());
+	std::sort(parents.begin(), parents.end());
+	std::vector<int> expectedParents(ranking.begin(), ranking.begin() + parents.size());
+	std::sort(expectedParents.begin(), expectedParents.end());
+	if (parents != expectedParents)
+	{
+		std::printf("Truncation selection picks different parents from a full sort\n");
+		return false;
+	}
+	std::vector<double> rankWeights(numberAgents);
+	std::vector<double> fitnessWeights(numberAgents);
+	for (int rank = 0; rank < numberAgents; rank++)
+	{
+		rankWeights[ranking[rank]] = numberAgents - rank;
+		fitnessWeights[ranking[rank]] = std::max(0, (int)fitnesses[ranking[rank]]);
+	}
+	std::vector<float> zeroFitnesses(numberAgents, 0);
+	for (int numberParents : { 1, 7, 200, 999, 5000 })
+	{
+		if (!isSampledEvenly(RankSelection, fitnesses, rankWeights, numberParents, random)
+			|| !isSampledEvenly(StochasticUniversalSelection, fitnesses, fitnessWeights, numberParents, random)
+			|| !isSampledEvenly(StochasticUniversalSelection, zeroFitnesses, std::vector<double>(numberAgents, 1), numberParents, random))
+		{
+			return false;
+		}
+	}
+	selectParents(TournamentSelection, fitnesses.data(), numberAgents, parents.size(), random, ranked, parents.data());
+	for (int parent : parents)
+	{
+		if (parent < 0 || parent >= numberAgents)
+		{
+			std::printf("Tournament selection picked agent %d of %d\n", parent, numberAgents);
+			return false;
+		}
+	}
+	return true;
+}
+VALIDATION(selection);
+
+/*
+Picks a fifth of the agents as parents and a tenth as the elite, as a generation does,
+reporting the throughput in agents per second. The full sort of every agent's index which
+generations used to rank agents by is timed for comparison
+*/
+static void runSelection(BenchmarkState &state, int numberAgents, SelectionStrategy strategy, bool fullSort)
+{
+	std::vector<float> fitnesses = makeFitnesses(numberAgents);
+	std::vector<RankedAgent> ranked;
+	ranked.reserve(numberAgents);
+	std::vector<int> elite(numberAgents / 10);
+	std::vector<int> parents(numberAgents / 5);
+	Random random(2);
+	state.itemsPerIteration = numberAgents;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		if (fullSort)
+		{
+			std::vector<int> ranking(numberAgents);
+			std::iota(ranking.begin(), ranking.end(), 0);
+			std::sort(ranking.begin(), ranking.end(), [&fitnesses](int agent1, int agent2)
+			{
+				return (int)fitnesses[agent1] > (int)fitnesses[agent2];
+			});
+			doNotOptimise(ranking[0]);
+			continue;
+		}
+		selectFittest(fitnesses.data(), numberAgents, elite.size(), ranked, elite.data());
+		selectParents(strategy, fitnesses.data(), numberAgents, parents.size(), random, ranked, parents.data());
+		doNotOptimise(parents[0]);
+	}
+}
+
+#define SELECTION_BENCHMARK(name, numberAgents, strategy, fullSort) \
+	static void name(BenchmarkState &state) \
+	{ \
+		runSelection(state, numberAgents, strategy, fullSort); \
+	} \
+	BENCHMARK(name)
+
+#define SELECTION_BENCHMARKS(suffix, numberAgents) \
+	SELECTION_BENCHMARK(selectSort##suffix, numberAgents, TruncationSelection, true); \
+	SELECTION_BENCHMARK(selectTruncation##suffix, numberAgents, TruncationSelection, false); \
+	SELECTION_BENCHMARK(selectTournament##suffix, numberAgents, TournamentSelection, false); \
+	SELECTION_BENCHMARK(selectRank##suffix, numberAgents, RankSelection, false); \
+	SELECTION_BENCHMARK(selectUniversal##suffix, numberAgents, StochasticUniversalSelection, false)
+
+SELECTION_BENCHMARKS(10k, 10000);
+SELECTION_BENCHMARKS(100k, 100000);
+SELECTION_BENCHMARKS(1M, 1000000);
+SELECTION_BENCHMARKS(10M, 10000000);
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include <cstdio>
+#include <cstdlib>
+#include "Benchmark.h"
+#include "../src/Simulation.h"
+#include "../src/Snapshot.h"
+
+static const int numberAgents = 100000;
+static const char *snapshotPath = "snapshot-benchmark.snap";
+
+// The default map with a large population so a snapshot is big enough to time
+static std::shared_ptr<const Track> getTrack()
+{
+	static std::shared_ptr<const Track> track;
+	if (!track)
+	{
+		Map map;
+		std::string error;
+		if (!loadMap("resources/map.txt", map, error))
+		{
+			std::printf("%s\n", error.c_str());
+			std::exit(1);
+		}
+		map.numberAgents = numberAgents;
+		track = std::make_shared<const Track>(map);
+	}
+	return track;
+}
+
+/*
+Copies a simulation's state into a snapshot, which is as long as a run stops for as the
+snapshot is written to disk in the background, reporting the throughput in agents per second
+*/
+static void snapshotCapture(BenchmarkState &state)
+{
+	Simulation simulation(getTrack());
+	SnapshotWriter writer;
+	const Population &population = simulation.getPopulation();
+	writer.begin(1, population.networkArchitecture, population.numberWeights, population.genomeStride);
+	simulation.saveState(writer);
+	state.itemsPerIteration = numberAgents;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		writer.begin(1, population.networkArchitecture, population.numberWeights, population.genomeStride);
+		simulation.saveState(writer);
+	}
+}
+BENCHMARK(snapshotCapture);
+
+// Checks a simulation restored from a snapshot has the population which was snapshotted
+static bool snapshotRoundTrip()
+{
+	Simulation original(getTrack(), 1, Random(1));
+	{
+		SnapshotWriter writer;
+		original.saveSnapshot(writer, snapshotPath);
+	}
+	Simulation simulation(getTrack());
+	bool valid = true;
+	{
+		SnapshotReader reader;
+		if (!reader.open(snapshotPath) || !simulation.restoreSnapshot(reader))
+		{
+			std::printf("Couldn't restore the snapshot: %s\n", reader.getError().c_str());
+			valid = false;
+		}
+		else if (simulation.getPopulation().genomes != original.getPopulation().genomes
+			|| simulation.getPopulation().heading != original.getPopulation().heading)
+		{
+			std::printf("The restored population differs from the one snapshotted\n");
+			valid = false;
+		}
+	}
+	std::remove(snapshotPath);
+	return valid;
+}
+VALIDATION(snapshotRoundTrip);
+
+// Maps a snapshot and restores a simulation from it, reporting the throughput in agents per second
+static void snapshotRestore(BenchmarkState &state)
+{
+	Simulation original(getTrack(), 1, Random(1));
+	{
+		SnapshotWriter writer;
+		original.saveSnapshot(writer, snapshotPath);
+	}
+	Simulation simulation(getTrack());
+	state.itemsPerIteration = numberAgents;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		SnapshotReader reader;
+		reader.open(snapshotPath);
+		simulation.restoreSnapshot(reader);
+		doNotOptimise(simulation.getGeneration());
+	}
+	std::remove(snapshotPath);
+}
+BENCHMARK(snapshotRestore);
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "Benchmark.h"
+#include "../src/SpatialGrid.h"
+
+static const int raysPerIteration = 1024;
+
+/*
+Scatters short random wall segments over an area which grows with their number, so the
+density of walls (and how far a ray travels before hitting one) is similar to the real map's
+*/
+static std::vector<Segment> makeSegments(int numberSegments, float &size)
+{
+	std::mt19937 generator(numberSegments);
+	size = std::sqrt(1000.0f * 600.0f * numberSegments / 20.0f);
+	std::uniform_real_distribution<float> position(0, size);
+	std::uniform_real_distribution<float> offset(-60, 60);
+	std::vector<Segment> segments;
+	for (int i = 0; i < numberSegments; i++)
+	{
+		Vector2 start = { position(generator), position(generator) };
+		segments.push_back({ start, { start.x + offset(generator), start.y + offset(generator) } });
+	}
+	return segments;
+}
+
+// Random rays (or body edges) in the area covered by the segments
+static std::vector<Segment> makeRays(float size)
+{
+	std::mt19937 generator(0);
+	std::uniform_real_distribution<float> position(0, size);
+	std::uniform_real_distribution<float> angle(0, 6.2831853f);
+	std::vector<Segment> rays;
+	for (int i = 0; i < raysPerIteration; i++)
+	{
+		float theta = angle(generator);
+		rays.push_back({ { position(generator), position(generator) }, { std::cos(theta), std::sin(theta) } });
+	}
+	return rays;
+}
+
+// Checks grids of each size benchmarked give exactly the same answers as testing every segment
+static bool spatialGrid()
+{
+	for (int numberSegments : { 20, 2000, 200000 })
+	{
+		float size;
+		std::vector<Segment> segments = makeSegments(numberSegments, size);
+		SpatialGrid bruteForce(segments, 0);
+		SpatialGrid grid(segments, SpatialGrid::chooseCellSize(segments));
+		for (const Segment &ray : makeRays(size))
+		{
+			Vector2 bodyEnd = { ray.start.x + ray.end.x * 24, ray.start.y + ray.end.y * 24 };
+			if (grid.castRay(ray.start, ray.end, 100) != bruteForce.castRay(ray.start, ray.end, 100)
+				|| grid.intersectsSegment(ray.start, bodyEnd) != bruteForce.intersectsSegment(ray.start, bodyEnd))
+			{
+				std::printf("Grid with %d segments disagrees with brute force\n", grid.getNumberSegments());
+				return false;
+			}
+		}
+	}
+	return true;
+}
+VALIDATION(spatialGrid);
+
+/*
+Casts sensor rays (or, for collisions, tests body edges 24 long) against walls made of the
+given number of segments, either through a grid or by testing every segment
+*/
+static void runWallQueries(BenchmarkState &state, int numberSegments, bool useGrid, bool collision)
+{
+	float size;
+	std::vector<Segment> segments = makeSegments(numberSegments, size);
+	std::vector<Segment> rays = makeRays(size);
+	SpatialGrid bruteForce(segments, 0);
+	SpatialGrid grid(segments, SpatialGrid::chooseCellSize(segments));
+	const SpatialGrid &walls = useGrid ? grid : bruteForce;
+	state.itemsPerIteration = raysPerIteration;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		float total = 0;
+		for (const Segment &ray : rays)
+		{
+			if (collision)
+			{
+				total += walls.intersectsSegment(ray.start, { ray.start.x + ray.end.x * 24, ray.start.y + ray.end.y * 24 });
+			}
+			else
+			{
+				total += std::min(walls.castRay(ray.start, ray.end, 100), 100.0f);
+			}
+		}
+		doNotOptimise(total);
+	}
+}
+
+#define WALL_BENCHMARK(name, numberSegments, useGrid, collision) \
+	static void name(BenchmarkState &state) \
+	{ \
+		runWallQueries(state, numberSegments, useGrid, collision); \
+	} \
+	BENCHMARK(name)
+
+WALL_BENCHMARK(castRayBruteForce20, 20, false, false);
+WALL_BENCHMARK(castRayBruteForce2k, 2000, false, false);
+WALL_BENCHMARK(castRayBruteForce200k, 200000, false, false);
+WALL_BENCHMARK(castRayGrid20, 20, true, false);
+WALL_BENCHMARK(castRayGrid2k, 2000, true, false);
+WALL_BENCHMARK(castRayGrid200k, 200000, true, false);
+WALL_BENCHMARK(collisionBruteForce20, 20, false, true);
+WALL_BENCHMARK(collisionBruteForce2k, 2000, false, true);
+WALL_BENCHMARK(collisionBruteForce200k, 200000, false, true);
+WALL_BENCHMARK(collisionGrid20, 20, true, true);
+WALL_BENCHMARK(collisionGrid2k, 2000, true, true);
+WALL_BENCHMARK(collisionGrid200k, 200000, true, true);
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include <cstdio>
+#include <cstdlib>
+#include "Benchmark.h"
+#include "../src/Simulation.h"
+
+static const int numberAgents = 2000;
+
+// The default map with the given population
+static std::shared_ptr<const Track> makeTrack(int numberAgents)
+{
+	Map map;
+	std::string error;
+	if (!loadMap("resources/map.txt", map, error))
+	{
+		std::printf("%s\n", error.c_str());
+		std::exit(1);
+	}
+	map.numberAgents = numberAgents;
+	return std::make_shared<const Track>(map);
+}
+
+// The default map with a larger population so a step has enough agents to time
+static std::shared_ptr<const Track> getTrack()
+{
+	static std::shared_ptr<const Track> track = makeTrack(numberAgents);
+	return track;
+}
+
+static bool isSamePopulation(const Population &population1, const Population &population2)
+{
+	return population1.positionX == population2.positionX && population1.positionY == population2.positionY
+		&& population1.heading == population2.heading && population1.fitness == population2.fitness
+		&& population1.failed == population2.failed && population1.turningLeft == population2.turningLeft
+		&& population1.passingCheckPoint == population2.passingCheckPoint
+		&& population1.lastCheckPoint == population2.lastCheckPoint
+		&& population1.currentCheckPoint == population2.currentCheckPoint && population1.ticks == population2.ticks
+		&& population1.lastProgressTick == population2.lastProgressTick
+		&& population1.checkPointsPassed == population2.checkPointsPassed && population1.genomes == population2.genomes;
+}
+
+/*
+Steps agents both with stepAgent and with the sequence a tick was before the step was fused:
+updateAgent, then updateAgentFitness with every check point, then checkAgentFail followed by
+the termination policy. Every agent's state, the check points reached and the agents failed
+must be the same after every tick
+*/
+static bool isSameAsUnfusedStep(const Population &population, const Track &track, const TerminationPolicy &policy, int generation)
+{
+	const std::vector<Segment> &checkPoints = track.getCheckPoints();
+	Population unfused = population;
+	Population fused = population;
+	std::vector<char> unfusedCheckPointsReached(checkPoints.size());
+	std::vector<char> fusedCheckPointsReached(checkPoints.size());
+	int numberFailed = 0;
+	for (int tick = 1; numberFailed < population.size(); tick++)
+	{
+		for (int agent = 0; agent < population.size(); agent++)
+		{
+			if (fused.failed[agent])
+			{
+				continue;
+			}
+			updateAgent(unfused, agent, track.getWalls());
+			for (int checkPoint = 0; checkPoint < (int)checkPoints.size(); checkPoint++)
+			{
+				if (updateAgentFitness(unfused, agent, checkPoints[checkPoint].start, checkPoints[checkPoint].end, checkPoint))
+				{
+					unfusedCheckPointsReached[checkPoint] = true;
+				}
+			}
+			bool unfusedFailed = checkAgentFail(unfused, agent, track.getWalls())
+				|| checkAgentTermination(unfused, agent, policy, checkPoints.size());
+			bool fusedFailed = stepAgent(fused, agent, track, policy, fusedCheckPointsReached.data());
+			if (unfusedFailed != fusedFailed)
+			{
+				std::printf("The fused step fails agent %d %s the unfused step on tick %d of generation %d\n", agent,
+					fusedFailed ? "before" : "after", tick, generation);
+				return false;
+			}
+			numberFailed += fusedFailed;
+		}
+		if (!isSamePopulation(unfused, fused) || unfusedCheckPointsReached != fusedCheckPointsReached)
+		{
+			std::printf("The fused step differs from the unfused step on tick %d of generation %d\n", tick, generation);
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+Checks the fused step against the unfused one with the genomes of a few evolved generations,
+with no termination policy and with one which stops agents early, and runs the fused and
+batched steps of two simulations side by side, checking every agent's state is the same after
+every tick
+*/
+static bool fusedStep()
+{
+	Simulation simulation(getTrack());
+	for (int generation = 0; generation < 3; generation++)
+	{
+		simulation.runGeneration();
+		for (TerminationPolicy policy : { TerminationPolicy(), TerminationPolicy{ 400, 100, 1 } })
+		{
+			if (!isSameAsUnfusedStep(simulation.getPopulation(), *getTrack(), policy, generation + 2))
+			{
+				return false;
+			}
+		}
+	}
+	Simulation batched(getTrack());
+	batched.setFusedStep(false);
+	Simulation fused(getTrack());
+	fused.setFusedStep(true);
+	for (int generation = 0; generation < 3; generation++)
+	{
+		while (!batched.isGenerationComplete() || !fused.isGenerationComplete())
+		{
+			batched.step();
+			fused.step();
+			if (!isSamePopulation(batched.getPopulation(), fused.getPopulation()))
+			{
+				std::printf("The fused step differs from the batched step in generation %d\n", generation + 1);
+				return false;
+			}
+		}
+		batched.nextGeneration();
+		fused.nextGeneration();
+	}
+	return true;
+}
+VALIDATION(fusedStep);
+
+/*
+Times the first generation of a new simulation, every tick until all of its agents fail.
+Every iteration starts from the same random genomes so the work done is always the same
+*/
+static void runStep(BenchmarkState &state, bool fusedStep)
+{
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		Simulation simulation(getTrack());
+		simulation.setFusedStep(fusedStep);
+		while (!simulation.isGenerationComplete())
+		{
+			simulation.step();
+		}
+		doNotOptimise(simulation.getPopulation().fitness[0]);
+	}
+}
+
+static void stepBatched(BenchmarkState &state)
+{
+	runStep(state, false);
+}
+BENCHMARK(stepBatched);
+
+static void stepFused(BenchmarkState &state)
+{
+	runStep(state, true);
+}
+BENCHMARK(stepFused);
+
+/*
+Evolves a new simulation until a fixed number of agents have been evaluated, reporting the
+throughput in evaluations per second, either a generation at a time or in the steady state
+*/
+static void runEvolution(BenchmarkState &state, bool steadyState)
+{
+	const int numberEvaluations = 4 * numberAgents;
+	state.itemsPerIteration = numberEvaluations;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		Simulation simulation(getTrack());
+		while (simulation.getNumberEvaluations() < numberEvaluations)
+		{
+			if (steadyState)
+			{
+				simulation.runSteadyState(numberAgents);
+			}
+			else
+			{
+				simulation.runGeneration();
+			}
+		}
+		doNotOptimise(simulation.getNumberEvaluations());
+	}
+}
+
+static void evolveGenerational(BenchmarkState &state)
+{
+	runEvolution(state, false);
+}
+BENCHMARK(evolveGenerational);
+
+static void evolveSteadyState(BenchmarkState &state)
+{
+	runEvolution(state, true);
+}
+BENCHMARK(evolveSteadyState);
+
+/*
+Evolves a new simulation scored on four cases, the map from its own pose and from three
+more, until as many agents have been run as in evolveGenerational, reporting the throughput
+in agents run per second. Agents are stopped after 2000 ticks as they may never crash from
+the other poses
+*/
+static void evolveMultiTrack(BenchmarkState &state)
+{
+	const int numberEvaluations = 4 * numberAgents;
+	std::vector<EvaluationCase> cases = { makeEvaluationCase(getTrack()), { getTrack(), { 100, 500 }, -30 },
+		{ getTrack(), { 500, 40 }, 180 }, { getTrack(), { 930, 100 }, 90 } };
+	state.itemsPerIteration = numberEvaluations;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		Simulation simulation(getTrack());
+		simulation.setTerminationPolicy({ 2000, 0, 0 });
+		simulation.setEvaluationCases(cases, MinFitness);
+		while (simulation.getNumberEvaluations() < numberEvaluations)
+		{
+			simulation.runGeneration();
+		}
+		doNotOptimise(simulation.getNumberEvaluations());
+	}
+}
+BENCHMARK(evolveMultiTrack);
+
+/*
+Runs generations of one simulation once it has warmed up, so the allocations reported are
+those of turning one generation over to the next, which should be none. Two threads are used
+so stepping through the thread pool is counted as well
+*/
+static void runTurnover(BenchmarkState &state, bool steadyState)
+{
+	Simulation simulation(getTrack(), 2);
+	for (int generation = 0; generation < 3; generation++)
+	{
+		steadyState ? simulation.runSteadyState(numberAgents) : simulation.runGeneration();
+	}
+	state.itemsPerIteration = numberAgents;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		GenerationStatistics statistics = steadyState ? simulation.runSteadyState(numberAgents) : simulation.runGeneration();
+		doNotOptimise(statistics.maxFitness);
+	}
+}
+
+static void turnoverGenerational(BenchmarkState &state)
+{
+	runTurnover(state, false);
+}
+BENCHMARK(turnoverGenerational);
+
+static void turnoverSteadyState(BenchmarkState &state)
+{
+	runTurnover(state, true);
+}
+BENCHMARK(turnoverSteadyState);
+
+
+/*
+Runs the first five generations of a new simulation of the given population on the default
+map with a thread for each core, as headless does by default, reporting the throughput in
+generations per second. Every iteration starts from the default seed so the work done is always
+the same
+*/
+static void runGenerations(BenchmarkState &state, int numberAgents)
+{
+	const int numberGenerations = 5;
+	std::shared_ptr<const Track> track = makeTrack(numberAgents);
+	state.itemsPerIteration = numberGenerations;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		Simulation simulation(track, 0);
+		for (int generation = 0; generation < numberGenerations; generation++)
+		{
+			doNotOptimise(simulation.runGeneration().maxFitness);
+		}
+	}
+}
+
+#define GENERATIONS_BENCHMARK(name, numberAgents) \
+	static void name(BenchmarkState &state) \
+	{ \
+		runGenerations(state, numberAgents); \
+	} \
+	BENCHMARK(name)
+
+GENERATIONS_BENCHMARK(generations100, 100);
+GENERATIONS_BENCHMARK(generations1k, 1000);
+GENERATIONS_BENCHMARK(generations10k, 10000);
\ No newline at end of file
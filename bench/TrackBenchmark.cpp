@@ -0,0 +1,155 @@
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include "Benchmark.h"
+#include "../src/Random.h"
+#include "../src/Simulation.h"
+#include "../src/TrackFile.h"
+#include "../src/TrackGenerator.h"
+
+static const char *mapPath = "track-benchmark.txt";
+static const char *trackPath = "track-benchmark.track";
+static const int numberAgents = 1000;
+static const int ticksPerIteration = 100;
+
+// A generated track with the given number of walls, the same every run
+static const Map &getGeneratedMap(int numberSegments)
+{
+	static std::map<int, Map> maps;
+	if (!maps.count(numberSegments))
+	{
+		TrackGeneratorOptions options;
+		options.numberSegments = numberSegments;
+		options.numberAgents = numberAgents;
+		options.seed = 1;
+		maps[numberSegments] = generateTrack(options);
+	}
+	return maps[numberSegments];
+}
+
+// Whether two tracks' walls give the same distances along random rays round the start
+static bool haveSameWalls(const Track &track1, const Track &track2)
+{
+	Random random(1);
+	Vector2 start = track1.getStartingPosition();
+	for (int ray = 0; ray < 10000; ray++)
+	{
+		Vector2 rayStart = { start.x + random.nextFloat() * 400 - 200, start.y + random.nextFloat() * 400 - 200 };
+		float angle = random.nextFloat() * 6.2831853f;
+		Vector2 direction = { std::cos(angle), std::sin(angle) };
+		if (track1.getWalls().castRay(rayStart, direction, 100) != track2.getWalls().castRay(rayStart, direction, 100))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Checks a generated track compiled into a track file of each size benchmarked has the map's walls
+static bool compiledTrack()
+{
+	for (int numberSegments : { 1000, 1000000 })
+	{
+		Track track(getGeneratedMap(numberSegments));
+		std::string error;
+		std::shared_ptr<const Track> compiled;
+		if (writeTrackFile(trackPath, track, error))
+		{
+			compiled = Track::load(trackPath, error);
+		}
+		std::remove(trackPath);
+		if (!compiled)
+		{
+			std::printf("%s\n", error.c_str());
+			return false;
+		}
+		if (!haveSameWalls(track, *compiled))
+		{
+			std::printf("The compiled track's walls differ from the map's with %d segments\n", numberSegments);
+			return false;
+		}
+	}
+	return true;
+}
+VALIDATION(compiledTrack);
+
+/*
+Parses a generated map file and builds its grid, as starting a run on a map file does,
+reporting the throughput in walls per second
+*/
+static void runLoadMap(BenchmarkState &state, int numberSegments)
+{
+	if (!saveMap(mapPath, getGeneratedMap(numberSegments)))
+	{
+		std::printf("Couldn't write %s\n", mapPath);
+		return;
+	}
+	std::string error;
+	state.itemsPerIteration = numberSegments;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		std::shared_ptr<const Track> track = Track::load(mapPath, error);
+		doNotOptimise(track);
+	}
+	std::remove(mapPath);
+}
+
+/*
+Maps a generated track compiled into a track file, as starting a run on it does, reporting
+the throughput in walls per second
+*/
+static void runLoadTrack(BenchmarkState &state, int numberSegments)
+{
+	Track track(getGeneratedMap(numberSegments));
+	std::string error;
+	if (!writeTrackFile(trackPath, track, error))
+	{
+		std::printf("%s\n", error.c_str());
+		return;
+	}
+	state.itemsPerIteration = numberSegments;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		std::shared_ptr<const Track> compiled = Track::load(trackPath, error);
+		doNotOptimise(compiled);
+	}
+	std::remove(trackPath);
+}
+
+/*
+Runs the first ticks of a new population on a generated track, reporting the throughput in
+agent ticks per second, to show how sensing and collisions scale with the size of the map
+*/
+static void runStepTrack(BenchmarkState &state, int numberSegments)
+{
+	std::shared_ptr<const Track> track = std::make_shared<const Track>(getGeneratedMap(numberSegments));
+	state.itemsPerIteration = numberAgents * ticksPerIteration;
+	state.resetTimer();
+	for (long long i = 0; i < state.iterations; i++)
+	{
+		Simulation simulation(track);
+		for (int tick = 0; tick < ticksPerIteration && !simulation.isGenerationComplete(); tick++)
+		{
+			simulation.step();
+		}
+		doNotOptimise(simulation.getPopulation().fitness[0]);
+	}
+}
+
+#define TRACK_BENCHMARK(name, function, numberSegments) \
+	static void name(BenchmarkState &state) \
+	{ \
+		function(state, numberSegments); \
+	} \
+	BENCHMARK(name)
+
+TRACK_BENCHMARK(loadMap1k, runLoadMap, 1000);
+TRACK_BENCHMARK(loadMap1M, runLoadMap, 1000000);
+TRACK_BENCHMARK(loadTrack1k, runLoadTrack, 1000);
+TRACK_BENCHMARK(loadTrack1M, runLoadTrack, 1000000);
+TRACK_BENCHMARK(stepTrack100, runStepTrack, 100);
+TRACK_BENCHMARK(stepTrack10k, runStepTrack, 10000);
+TRACK_BENCHMARK(stepTrack1M, runStepTrack, 1000000);
\ No newline at end of file
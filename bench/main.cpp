@@ -0,0 +1,61 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "Benchmark.h"
+
+void printUsage()
+{
+	std::fprintf(stderr, "Usage: benchmarks [filter] [--repetitions n] [--json file] [--baseline file] [--threshold percent]\n"
+		"       benchmarks --validate [filter]\n");
+}
+
+/*
+Runs the benchmarks from the repository root (so resources/map.txt can be found). Only
+benchmarks whose names contain the filter are run. --json writes the results to a file which
+a later run can be compared with by --baseline, exiting with 1 if any benchmark is more than
+--threshold percent (5 by default) slower than it was. --repetitions repeats each timed run
+and keeps the fastest, which makes the comparison less sensitive to noise. --validate runs the
+validations whose names contain the filter instead, exiting with 1 if any of them fail
+*/
+int main(int argc, char *argv[])
+{
+	BenchmarkOptions options;
+	bool hasFilter = false;
+	bool validate = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (option == "--repetitions" && hasValue)
+		{
+			options.repetitions = std::atoi(argv[++i]);
+		}
+		else if (option == "--json" && hasValue)
+		{
+			options.jsonPath = argv[++i];
+		}
+		else if (option == "--baseline" && hasValue)
+		{
+			options.baselinePath = argv[++i];
+		}
+		else if (option == "--threshold" && hasValue)
+		{
+			options.regressionThreshold = std::atof(argv[++i]);
+		}
+		else if (option == "--validate")
+		{
+			validate = true;
+		}
+		else if (option.compare(0, 2, "--") != 0 && !hasFilter)
+		{
+			options.filter = option;
+			hasFilter = true;
+		}
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+	return validate ? runValidations(options.filter) : runBenchmarks(options);
+}
\ No newline at end of file
@@ -1,79 +1,38 @@
+#include <cmath>
 #include "Agent.h"
+#include "Instrumentation.h"
+#include "Network.h"
 
-#define PI 3.1415926536
-
-// Sigmoid activation function
-float sigmoid(float x)
-{
-	return 1 / (1 + exp(-x));
-}
-
-// Convert from degrees to radians
-float radians(float theta)
+/*
+The corners of the agent's triangular body for a pose whose heading has the given cosine and
+sine. These are also where the sensor rays start
+*/
+static void getBodyCorners(Vector2 position, double cosine, double sine, Vector2 &nose, Vector2 &leftCorner, Vector2 &rightCorner)
 {
-	return (PI / 180) * theta;
+	nose = position;
+	nose.x += cosine * 16.0f;
+	nose.y += sine * 16.0f;
+	leftCorner = position;
+	leftCorner.x += cosine * -8.0f - sine * -8.0f;
+	leftCorner.y += sine * -8.0f + cosine * -8.0f;
+	rightCorner = position;
+	rightCorner.x += cosine * -8.0f - sine * 8.0f;
+	rightCorner.y += sine * -8.0f + cosine * 8.0f;
 }
 
-// Find intersection point between two line segments from their start and end coordinates
-intersectionPoint checkIntersection(sf::Vector2f line1Start, sf::Vector2f line1End, sf::Vector2f line2Start, sf::Vector2f line2End)
+/*
+Writes the distance to the nearest wall along each of the three sightlines of a pose, divided
+by the sensors' range of 100 and capped at 1, to inputDistances[i * inputStride]
+*/
+static void senseWalls(Vector2 position, double cosine, double sine, const SpatialGrid &walls, float *inputDistances, int inputStride)
 {
-	float deltaLine1X = line1Start.x - line1End.x;
-	float deltaLine2X = line2Start.x - line2End.x;
-	float deltaLine1Y = line1Start.y - line1End.y;
-	float deltaLine2Y = line2Start.y - line2End.y;
-	float denominator = deltaLine1X * deltaLine2Y - deltaLine1Y * deltaLine2X;
-	// Handle parallel lines
-	if (denominator == 0)
-	{
-		return { 0, 0 };
-	}
-	// Proportion along line1 point of intersection is
-	float lambda = ((line1Start.x - line2Start.x) * deltaLine2Y - (line1Start.y - line2Start.y) * deltaLine2X) / denominator;
-	// Proportion along line2 point of intersection is
-	float mu = -(deltaLine1X * (line1Start.y - line2Start.y) - deltaLine1Y * (line1Start.x - line2Start.x)) / denominator;
-	return { lambda, mu };
-}
-
-Agent::Agent(std::vector<Matrix> weights, sf::Vector2f startPosition, int startRotation, std::vector<sf::VertexArray> mapData)
-	: weights(weights), mapData(mapData)
-{
-	// Build ship by adding coordinates of vertices
-	ship.setPointCount(4);
-	ship.setPoint(0, { 0 , 0 });
-	ship.setPoint(1, { -8, 8 });
-	ship.setPoint(2, { 16, 0 });
-	ship.setPoint(3, { -8, -8 });
-	ship.setPosition(startPosition);
-	ship.setRotation(startRotation);
-	ship.setFillColor({ 0,0,0,0 });
-	ship.setOutlineColor(sf::Color::Black);
-	ship.setOutlineThickness(1);
-}
-
-Agent::~Agent()
-{
-}
-
-void Agent::draw(sf::RenderWindow &window)
-{
-	if (failed)
-	{
-		return;
-	}
-	window.draw(ship);
-}
-
-void Agent::update()
-{
-	fitness += 1;
-	// Get input to neural network
-	std::vector<float> inputDistances = { 1, 1, 1 };
-	float rotation = radians(ship.getRotation());
+	INSTRUMENT_SCOPE(SenseTimer);
+	Vector2 nose, leftCorner, rightCorner;
+	getBodyCorners(position, cosine, sine, nose, leftCorner, rightCorner);
 	for (int currentRay = 0; currentRay < 3; currentRay++)
 	{
-		sf::Vector2f rayStart = ship.getPosition();
-		sf::Vector2f rayEnd;
-		sf::Vector2f rayDirection;
+		Vector2 rayStart;
+		Vector2 rayDirection;
 		/* 
 		Sets the start and end positions of each ray. There are three rays, one
 		which looks directly to the left of the agent, one to the right, and one
@@ -82,143 +41,66 @@ void Agent::update()
 		switch (currentRay)
 		{
 		case 0:
-			rayStart.x += cos(rotation) * -8.0f - sin(rotation) * -8.0f;
-			rayStart.y += sin(rotation) * -8.0f + cos(rotation) * -8.0f;
-			rayDirection.x = sin(rotation);
-			rayDirection.y = -cos(rotation);
+			rayStart = leftCorner;
+			rayDirection.x = sine;
+			rayDirection.y = -cosine;
 			break;
 		case 1:
-			rayStart.x += cos(rotation) * -8.0f - sin(rotation) * 8.0f;
-			rayStart.y += sin(rotation) * -8.0f + cos(rotation) * 8.0f;
-			rayDirection.x = -sin(rotation);
-			rayDirection.y = cos(rotation);
+			rayStart = rightCorner;
+			rayDirection.x = -sine;
+			rayDirection.y = cosine;
 			break;
 		case 2:
-			rayStart.x += cos(rotation) * 16.0f;
-			rayStart.y += sin(rotation) * 16.0f;
-			rayDirection.x = cos(rotation);
-			rayDirection.y = sin(rotation);
-		}
-		rayEnd = rayStart + rayDirection;
-		for (sf::VertexArray mapElement : mapData)
-		{
-			sf::Vector2f point1;
-			sf::Vector2f point2;
-			for (int i = 0; i < mapElement.getVertexCount() - 1; i++)
-			{
-				// Vertices of line segment of map wall
-				point1 = mapElement[i].position;
-				point2 = mapElement[i + 1].position;
-
-				intersectionPoint intersection = checkIntersection(point1, point2, rayStart, rayEnd);
-				float lambda = intersection.lambda;
-				float mu = intersection.mu;
-				// Handles parallel lines 
-				if (lambda == 0 && mu == 0)
-				{
-					continue;
-				}
-				// Checks there is an intersection
-				else if (0 < lambda && lambda < 1 && mu > 0)
-				{
-					float distance = mu / 100;
-					// Checks if closest line segment to vertex
-					if (distance < inputDistances[currentRay])
-					{
-						inputDistances[currentRay] = distance;
-					}
-				}
-			}
+			rayStart = nose;
+			rayDirection.x = cosine;
+			rayDirection.y = sine;
 		}
+		// Only walls closer than 100 affect the input so the ray doesn't need to go any further
+		float distance = walls.castRay(rayStart, rayDirection, 100) / 100;
+		inputDistances[currentRay * inputStride] = distance < 1 ? distance : 1;
 	}
-	// Feed the input through the neural network to obtain the output decision 
-	Matrix networkOutput(1, 3, inputDistances);
-	for (Matrix currentWeights : weights)
+}
+
+// The agent's network's decision for the given inputs
+static bool decideAgent(const Population &population, int agent, const float *inputDistances, int inputStride)
+{
+	INSTRUMENT_SCOPE(InferenceTimer);
+	const float *genome = population.getGenome(agent);
+	if (isAgentNetwork(population.networkArchitecture))
 	{
-		networkOutput = networkOutput * currentWeights;
-		for (int node = 0; node < networkOutput.getDimensions().columns; node++)
-		{
-			float nodePreActivation = networkOutput(0, node);
-			float nodeValue = sigmoid(nodePreActivation);
-			networkOutput.setData(0, node, nodeValue);
-		}
+		return decideFixed(inputDistances, inputStride, genome);
 	}
+	return decideReference(inputDistances, inputStride, genome, population.networkArchitecture);
+}
+
+// Turns the agent according to its network's decision and returns its new heading
+static float turnAgent(Population &population, int agent, bool turnLeft)
+{
+	float heading = population.heading[agent];
+	population.fitness[agent] += 1;
+	population.ticks[agent] += 1;
+	INSTRUMENT_COUNT(AgentTicks, 1);
 	// Rotate and move the agent according to the output decision 
-	if (networkOutput(0, 0) >= networkOutput(0, 1))
+	if (turnLeft)
 	{ //Turn left
-		ship.rotate(-2.0f);
-		ship.setFillColor(sf::Color::Red);
+		heading = wrapRotation(heading - 2.0f);
+		population.turningLeft[agent] = true;
 	}
 	else
 	{ //Turn right
-		ship.rotate(2.0f);
-		ship.setFillColor(sf::Color::Blue);
-	}
-	ship.move({ 2.0f * cos(radians(ship.getRotation())), 2.0f * sin(radians(ship.getRotation())) });
-}
-
-// Tests if agent has collided with wall
-bool Agent::checkFail()
-{
-	if (failed)
-	{
-		return true;
-	}
-	float rotation = radians(ship.getRotation());
-	sf::Vector2f testLineStart = ship.getPosition();
-	testLineStart.x += cos(rotation) * 16.0f;
-	testLineStart.y += sin(rotation) * 16.0f;
-	// For each line of the bounding box of the agent (which is a triangle)
-	for (int testLine = 0; testLine < 2; testLine++)
-	{
-		sf::Vector2f testLineEnd = ship.getPosition();
-		switch (testLine)
-		{
-		case 0:
-			testLineEnd.x += cos(rotation) * -8.0f - sin(rotation) * -8.0f;
-			testLineEnd.y += sin(rotation) * -8.0f + cos(rotation) * -8.0f;
-			break;
-		case 1:
-			testLineEnd.x += cos(rotation) * -8.0f - sin(rotation) * 8.0f;
-			testLineEnd.y += sin(rotation) * -8.0f + cos(rotation) * 8.0f;
-			break;
-		}
-		// Finds intersection with each bounding line and each line in the map
-		for (sf::VertexArray mapElement : mapData)
-		{
-			sf::Vector2f point1;
-			sf::Vector2f point2;
-			for (int i = 0; i < mapElement.getVertexCount() - 1; i++)
-			{
-				point1 = mapElement[i].position;
-				point2 = mapElement[i + 1].position;
-				intersectionPoint intersection = checkIntersection(point1, point2, testLineStart, testLineEnd);
-				float lambda = intersection.lambda;
-				float mu = intersection.mu;
-				if (lambda == 0 && mu == 0)
-				{
-					continue;
-				}
-				if (0 <= lambda && lambda <= 1 && 0 <= mu && mu <= 1)
-				{
-					failed = true;
-					return true;
-				}
-			}
-		}
+		heading = wrapRotation(heading + 2.0f);
+		population.turningLeft[agent] = false;
 	}
-	return false;
+	population.heading[agent] = heading;
+	return heading;
 }
 
-// Updates fitness each tine a checkpoint is passed
-bool Agent::updateFitness(sf::Vector2f checkPointStart, sf::Vector2f checkPointEnd, int checkPointIndex)
+/*
+Updates the agent's check point state when its body runs from bodyStart to bodyEnd, returning
+whether it is crossing the check point
+*/
+static bool crossCheckPoint(Population &population, int agent, Vector2 bodyStart, Vector2 bodyEnd, Vector2 checkPointStart, Vector2 checkPointEnd, int checkPointIndex)
 {
-	// Body is a line segment running though the agent
-	sf::Vector2f bodyStart = ship.getPosition();
-	sf::Vector2f bodyEnd = ship.getPosition();
-	bodyEnd.x += cos(radians(ship.getRotation())) * 16.0f;
-	bodyEnd.y += sin(radians(ship.getRotation())) * 16.0f;
-
 	// Find intersection between body and checkpoint
 	intersectionPoint intersection = checkIntersection(bodyStart, bodyEnd, checkPointStart, checkPointEnd);
 	float lambda = intersection.lambda;
@@ -229,99 +111,166 @@ bool Agent::updateFitness(sf::Vector2f checkPointStart, sf::Vector2f checkPointE
 	}
 	if (0 < lambda && lambda < 1 && 0 < mu && mu < 1)
 	{
-		if (checkPointIndex == lastCheckPoint)
+		if (checkPointIndex == population.lastCheckPoint[agent])
 		{
-			failed = true;
+			population.failed[agent] = true;
 			return false;
 		}
 		// Increase fitness if passed checkpoint only if not already passed it
-		if (!passingCheckPoint)
+		if (!population.passingCheckPoint[agent])
 		{
-			fitness += 100.0f;
+			population.fitness[agent] += 100.0f;
+			population.checkPointsPassed[agent] += 1;
+			population.lastProgressTick[agent] = population.ticks[agent];
 		}
-		passingCheckPoint = true;
-		currentCheckPoint = checkPointIndex;
+		population.passingCheckPoint[agent] = true;
+		population.currentCheckPoint[agent] = checkPointIndex;
 		return true;
 	}
-	if (passingCheckPoint && checkPointIndex == currentCheckPoint)
+	if (population.passingCheckPoint[agent] && checkPointIndex == population.currentCheckPoint[agent])
 	{
-		lastCheckPoint = checkPointIndex;
-		passingCheckPoint = false;
+		population.lastCheckPoint[agent] = checkPointIndex;
+		population.passingCheckPoint[agent] = false;
 	}
 	return false;
 }
 
-// Getter
-bool Agent::isFailed()
+/*
+Senses the walls, feeds the distances through the agent's network and moves it one tick.
+The agents' usual architecture is evaluated with fixed size matrices so this doesn't allocate
+*/
+void updateAgent(Population &population, int agent, const SpatialGrid &walls)
+{
+	float inputDistances[maxLayerWidth];
+	senseAgent(population, agent, walls, inputDistances, 1);
+	moveAgent(population, agent, decideAgent(population, agent, inputDistances, 1));
+}
+
+/*
+Finds the network inputs for an agent from the distance to the nearest wall along each of
+its three sightlines. Input i is written to inputDistances[i * inputStride] so the inputs of
+a whole batch of agents can be gathered together
+*/
+void senseAgent(Population &population, int agent, const SpatialGrid &walls, float *inputDistances, int inputStride)
 {
-	return failed;
+	Vector2 position = { population.positionX[agent], population.positionY[agent] };
+	float rotation = radians(population.heading[agent]);
+	senseWalls(position, cos(rotation), sin(rotation), walls, inputDistances, inputStride);
 }
 
-// Mutate fitness by random amount to add more random selection
-void Agent::mutateFitness()
+// Rotates and moves the agent according to its network's decision
+void moveAgent(Population &population, int agent, bool turnLeft)
 {
-	fitness *= ((float)rand() / RAND_MAX / 5) + 0.9;
+	float heading = turnAgent(population, agent, turnLeft);
+	population.positionX[agent] += (float)(2.0f * cos(radians(heading)));
+	population.positionY[agent] += (float)(2.0f * sin(radians(heading)));
 }
 
-// Random weights will be changed by a small amount
-void Agent::softMutate(int mutationRate)
+// Tests if agent has collided with wall
+bool checkAgentFail(Population &population, int agent, const SpatialGrid &walls)
 {
-	for (int currentWeights = 0; currentWeights < weights.size(); currentWeights++)
+	INSTRUMENT_SCOPE(CollisionTimer);
+	if (population.failed[agent])
 	{
-		int rows = weights[currentWeights].getDimensions().rows;
-		int columns = weights[currentWeights].getDimensions().columns;
-		for (int row = 0; row < rows; row++)
-		{
-			for (int column = 0; column < columns; column++)
-			{
-				/*
-				The mutation rate is a percentage which indicates what percentage of weights (on average)
-				will be mutated by a small value
-				*/
-				if (rand() % 100 < mutationRate)
-				{
-					float weightDelta = ((float)rand() / RAND_MAX - 0.5) / 10;
-					weights[currentWeights].setData(row, column, weights[currentWeights](row, column) + weightDelta);
-				}
-			}
-		}
+		return true;
+	}
+	Vector2 position = { population.positionX[agent], population.positionY[agent] };
+	float rotation = radians(population.heading[agent]);
+	Vector2 nose, leftCorner, rightCorner;
+	getBodyCorners(position, cos(rotation), sin(rotation), nose, leftCorner, rightCorner);
+	// For each line of the bounding box of the agent (which is a triangle)
+	if (walls.intersectsSegment(nose, leftCorner) || walls.intersectsSegment(nose, rightCorner))
+	{
+		population.failed[agent] = true;
+		return true;
 	}
+	return false;
 }
 
+// Updates fitness each tine a checkpoint is passed
+bool updateAgentFitness(Population &population, int agent, Vector2 checkPointStart, Vector2 checkPointEnd, int checkPointIndex)
+{
+	INSTRUMENT_SCOPE(CheckPointTimer);
+	Vector2 position = { population.positionX[agent], population.positionY[agent] };
+	float heading = population.heading[agent];
+	// Body is a line segment running though the agent
+	Vector2 bodyEnd = position;
+	bodyEnd.x += cos(radians(heading)) * 16.0f;
+	bodyEnd.y += sin(radians(heading)) * 16.0f;
+	return crossCheckPoint(population, agent, position, bodyEnd, checkPointStart, checkPointEnd, checkPointIndex);
+}
 
-// Random weights will be rewritten by new random weight value
-void Agent::hardMutate(int mutationRate)
+/*
+Fails an agent which has run out of ticks, stalled or finished its laps of a track with the
+given number of check points, returning whether it did
+*/
+bool checkAgentTermination(Population &population, int agent, const TerminationPolicy &policy, int numberCheckPoints)
 {
-	for (int currentWeights = 0; currentWeights < weights.size(); currentWeights++)
+	int ticks = population.ticks[agent];
+	if ((policy.maxTicks > 0 && ticks >= policy.maxTicks)
+		|| (policy.stallTicks > 0 && ticks - population.lastProgressTick[agent] >= policy.stallTicks)
+		|| (policy.laps > 0 && population.checkPointsPassed[agent] >= policy.laps * numberCheckPoints))
 	{
-		int rows = weights[currentWeights].getDimensions().rows;
-		int columns = weights[currentWeights].getDimensions().columns;
-		for (int row = 0; row < rows; row++)
-		{
-			for (int column = 0; column < columns; column++)
-			{
-				/*
-				The mutation rate is a percentage which indicates what percentage of weights (on average)
-				will be mutated to a random value
-				*/
-				if (rand() % 100 < mutationRate)
-				{
-					float newWeight = ((float)rand() / (RAND_MAX)) * 2 - 1;
-					weights[currentWeights].setData(row, column, newWeight);
-				}
-			}
-		}
+		population.failed[agent] = true;
+		return true;
 	}
+	return false;
 }
 
-// Getter
-int Agent::getFitness()
+/*
+Runs a whole tick for a live agent in one pass: sensing, deciding, moving, crossing check
+points and colliding with walls. The sine and cosine of each pose are worked out once and
+shared by every step that needs them, the body is found once for all of the check points
+and both edges of the body are tested against the walls in a single grid query. The results
+are bit for bit those of running the separate steps in turn. Any check points being crossed
+are marked in checkPointsReached and it returns whether the agent failed or was stopped by
+the termination policy
+*/
+bool stepAgent(Population &population, int agent, const Track &track, const TerminationPolicy &policy, char *checkPointsReached)
 {
-	return fitness;
-}
+	const SpatialGrid &walls = track.getWalls();
+	Vector2 position = { population.positionX[agent], population.positionY[agent] };
+	float rotation = radians(population.heading[agent]);
+	float inputDistances[maxLayerWidth];
+	senseWalls(position, cos(rotation), sin(rotation), walls, inputDistances, 1);
+	bool turnLeft = decideAgent(population, agent, inputDistances, 1);
 
-// Getter
-std::vector<Matrix> Agent::getNetwork()
-{
-	return weights;
+	rotation = radians(turnAgent(population, agent, turnLeft));
+	double cosine = cos(rotation);
+	double sine = sin(rotation);
+	position.x += (float)(2.0f * cosine);
+	position.y += (float)(2.0f * sine);
+	population.positionX[agent] = position.x;
+	population.positionY[agent] = position.y;
+
+	Vector2 nose, leftCorner, rightCorner;
+	getBodyCorners(position, cosine, sine, nose, leftCorner, rightCorner);
+	const std::vector<Segment> &checkPoints = track.getCheckPoints();
+	{
+		INSTRUMENT_SCOPE(CheckPointTimer);
+		for (int currentCheckPoint = 0; currentCheckPoint < (int)checkPoints.size(); currentCheckPoint++)
+		{
+			const Segment &checkPoint = checkPoints[currentCheckPoint];
+			if (crossCheckPoint(population, agent, position, nose, checkPoint.start, checkPoint.end, currentCheckPoint))
+			{
+				checkPointsReached[currentCheckPoint] = true;
+			}
+		}
+	}
+	if (population.failed[agent])
+	{
+		return true;
+	}
+	Vector2 corners[2] = { leftCorner, rightCorner };
+	bool collided;
+	{
+		INSTRUMENT_SCOPE(CollisionTimer);
+		collided = walls.intersectsSegments(nose, corners, 2);
+	}
+	if (collided)
+	{
+		population.failed[agent] = true;
+		return true;
+	}
+	return checkAgentTermination(population, agent, policy, checkPoints.size());
 }
\ No newline at end of file
@@ -1,48 +1,35 @@
 #pragma once
-#include <SFML/Graphics.hpp>
-#include <vector>
-#include "Matrix.h"
-
-struct intersectionPoint
+#include "Population.h"
+#include "SpatialGrid.h"
+#include "Track.h"
+
+/*
+Limits which end an agent's run early, each of which is disabled when 0: a maximum number of
+ticks, a number of ticks without reaching a new check point and a number of laps of the
+track. An agent stopped by one is failed like one which crashed, keeping its fitness, so the
+length of a generation is bounded however well the agents drive
+*/
+struct TerminationPolicy
 {
-	float lambda;
-	float mu;
+	int maxTicks = 0;
+	int stallTicks = 0;
+	int laps = 0;
 };
 
-class Agent
-{
-public:
-	Agent(std::vector<Matrix>, sf::Vector2f, int, std::vector<sf::VertexArray>);
-	~Agent();
-
-	void draw(sf::RenderWindow&);
-
-	void update();
-
-	bool checkFail();
-
-	bool updateFitness(sf::Vector2f, sf::Vector2f, int);
-
-	bool isFailed();
-
-	void mutateFitness();
+/*
+The per agent simulation steps. An agent is an index into the population's arrays and all
+of its state is read from and written back to there
+*/
+void updateAgent(Population&, int, const SpatialGrid&);
 
-	void softMutate(int);
+void senseAgent(Population&, int, const SpatialGrid&, float*, int);
 
-	void hardMutate(int);
+void moveAgent(Population&, int, bool);
 
-	int getFitness();
+bool checkAgentFail(Population&, int, const SpatialGrid&);
 
-	std::vector<Matrix> getNetwork();
+bool updateAgentFitness(Population&, int, Vector2, Vector2, int);
 
-private:
-	sf::ConvexShape ship;
-	std::vector<Matrix> weights;
-	std::vector<sf::VertexArray> mapData;
+bool checkAgentTermination(Population&, int, const TerminationPolicy&, int);
 
-	bool failed = false;
-	float fitness = 1.0f;
-	bool passingCheckPoint = false;
-	int lastCheckPoint = 1;
-	int currentCheckPoint = 0;
-};
\ No newline at end of file
+bool stepAgent(Population&, int, const Track&, const TerminationPolicy&, char*);
\ No newline at end of file
@@ -0,0 +1,443 @@
+#include "Coordinator.h"
+#if DISTRIBUTED_EVALUATION
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Simulation.h"
+
+static const uint32_t messageMagic = 0x47454E41;
+
+// Writes the whole buffer, carrying on after partial writes and interruptions
+static bool writeAll(int socket, const void *data, size_t size)
+{
+	const char *bytes = (const char*)data;
+	while (size > 0)
+	{
+		ssize_t written = write(socket, bytes, size);
+		if (written < 0 && errno == EINTR) continue;
+		if (written <= 0) return false;
+		bytes += written;
+		size -= written;
+	}
+	return true;
+}
+
+// Reads exactly size bytes, failing if the other end closes the socket first
+static bool readAll(int socket, void *data, size_t size)
+{
+	char *bytes = (char*)data;
+	while (size > 0)
+	{
+		ssize_t received = read(socket, bytes, size);
+		if (received < 0 && errno == EINTR) continue;
+		if (received <= 0) return false;
+		bytes += received;
+		size -= received;
+	}
+	return true;
+}
+
+static bool sendMessage(int socket, MessageHeader header, const float *payload, size_t payloadSize)
+{
+	header.magic = messageMagic;
+	return writeAll(socket, &header, sizeof(header)) && writeAll(socket, payload, payloadSize * sizeof(float));
+}
+
+/*
+Starts the given number of workers along with as many spares to replace them over the run.
+The spares are forked now rather than when a worker fails, as by then the caller may have
+started other threads
+*/
+Coordinator::Coordinator(std::vector<EvaluationCase> cases, int numberWorkers, int batchSize, int maxBatchesInFlight)
+	: cases(cases), workers(numberWorkers), pollSockets(numberWorkers), batchSize(std::min(std::max(batchSize, 1), maxBatchSize)),
+	maxBatchesInFlight(std::max(maxBatchesInFlight, 1))
+{
+	// A worker dying mid write should be reported as a failed write rather than killing the coordinator
+	signal(SIGPIPE, SIG_IGN);
+	for (Worker &worker : workers)
+	{
+		startWorker(worker);
+	}
+	spares.reserve(numberWorkers);
+	for (int i = 0; i < numberWorkers; i++)
+	{
+		Worker spare;
+		if (startWorker(spare))
+		{
+			spares.push_back(spare);
+		}
+	}
+}
+
+Coordinator::~Coordinator()
+{
+	workers.insert(workers.end(), spares.begin(), spares.end());
+	for (Worker &worker : workers)
+	{
+		if (worker.socket >= 0)
+		{
+			MessageHeader header = { 0, ShutdownMessage, 0, 0, 0, 0, 0, 0, 0 };
+			sendMessage(worker.socket, header, nullptr, 0);
+		}
+		stopWorker(worker);
+	}
+}
+
+/*
+Forks a worker connected to the coordinator by a socket pair. The child closes the
+coordinator's ends of every socket, the spares' included, so each worker only sees its own.
+Only the coordinator's end is made non-blocking, the worker reads and writes its end in turn
+*/
+bool Coordinator::startWorker(Worker &worker)
+{
+	int sockets[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+	{
+		return false;
+	}
+	pid_t process = fork();
+	if (process < 0)
+	{
+		close(sockets[0]);
+		close(sockets[1]);
+		return false;
+	}
+	if (process == 0)
+	{
+		close(sockets[0]);
+		for (Worker &other : workers)
+		{
+			if (other.socket >= 0) close(other.socket);
+		}
+		for (Worker &other : spares)
+		{
+			close(other.socket);
+		}
+		runWorker(sockets[1], cases);
+	}
+	close(sockets[1]);
+	fcntl(sockets[0], F_SETFL, fcntl(sockets[0], F_GETFL) | O_NONBLOCK);
+	worker.socket = sockets[0];
+	worker.process = process;
+	return true;
+}
+
+// Closes the worker's socket, which ends it if it is still running, and waits for it to exit
+void Coordinator::stopWorker(Worker &worker)
+{
+	if (worker.socket < 0)
+	{
+		return;
+	}
+	close(worker.socket);
+	waitpid(worker.process, nullptr, 0);
+	worker.socket = -1;
+	worker.process = -1;
+}
+
+/*
+Puts the batches of a worker which has stopped responding back at the front of the queue, or
+evaluates them here once they have been tried too many times, and replaces the worker with a
+spare if any are left. Batches the worker hadn't started being sent don't count as an attempt
+*/
+void Coordinator::failWorker(Worker &worker, std::deque<int> &pending)
+{
+	kill(worker.process, SIGKILL);
+	stopWorker(worker);
+	for (int i = (int)worker.batches.size() - 1; i >= 0; i--)
+	{
+		Batch &batch = batches[worker.batches[i]];
+		bool attempted = i < worker.sentBatches || (i == worker.sentBatches && worker.sendOffset > 0);
+		if (!attempted || ++batch.attempts < maxAttempts)
+		{
+			pending.push_front(worker.batches[i]);
+		}
+		else
+		{
+			evaluateGenomes(cases[caseId], policy, genomes + (size_t)batch.begin * genomeStride, genomeStride,
+				batch.end - batch.begin, fitnesses + batch.begin);
+		}
+	}
+	worker.batches.clear();
+	worker.sentBatches = 0;
+	worker.sendOffset = 0;
+	worker.receiveOffset = 0;
+	std::cerr << "Worker " << &worker - workers.data() << " failed";
+	if (!spares.empty())
+	{
+		worker.socket = spares.back().socket;
+		worker.process = spares.back().process;
+		spares.pop_back();
+		numberRestarts++;
+		std::cerr << " and was replaced";
+	}
+	std::cerr << '\n';
+}
+
+/*
+Writes the requests for the worker's batches which haven't been sent yet for as long as the
+socket takes them. Returns false if the worker has gone
+*/
+bool Coordinator::sendRequests(Worker &worker)
+{
+	while (worker.sentBatches < (int)worker.batches.size())
+	{
+		int batch = worker.batches[worker.sentBatches];
+		int count = batches[batch].end - batches[batch].begin;
+		if (worker.sendOffset == 0)
+		{
+			worker.request = { messageMagic, EvaluateMessage, (uint32_t)batch, (uint32_t)caseId, (uint32_t)count, (uint32_t)genomeStride,
+				(uint32_t)policy.maxTicks, (uint32_t)policy.stallTicks, (uint32_t)policy.laps };
+		}
+		size_t payloadSize = (size_t)count * genomeStride * sizeof(float);
+		const char *data = (const char*)&worker.request + worker.sendOffset;
+		size_t size = sizeof(MessageHeader) - worker.sendOffset;
+		if (worker.sendOffset >= sizeof(MessageHeader))
+		{
+			size_t offset = worker.sendOffset - sizeof(MessageHeader);
+			data = (const char*)(genomes + (size_t)batches[batch].begin * genomeStride) + offset;
+			size = payloadSize - offset;
+		}
+		ssize_t written = write(worker.socket, data, size);
+		if (written < 0 && errno == EINTR) continue;
+		if (written < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+		worker.sendOffset += written;
+		if (worker.sendOffset == sizeof(MessageHeader) + payloadSize)
+		{
+			worker.sentBatches++;
+			worker.sendOffset = 0;
+		}
+	}
+	return true;
+}
+
+/*
+Reads as much of the worker's replies as has arrived, putting the fitnesses of each batch in
+place as they come in. Returns false if the worker has gone or replies with anything but the
+fitnesses of the first batch it was sent
+*/
+bool Coordinator::receiveReplies(Worker &worker)
+{
+	while (worker.sentBatches > 0)
+	{
+		int batch = worker.batches.front();
+		int count = batches[batch].end - batches[batch].begin;
+		size_t payloadSize = (size_t)count * sizeof(float);
+		char *data = (char*)&worker.reply + worker.receiveOffset;
+		size_t size = sizeof(MessageHeader) - worker.receiveOffset;
+		if (worker.receiveOffset >= sizeof(MessageHeader))
+		{
+			size_t offset = worker.receiveOffset - sizeof(MessageHeader);
+			data = (char*)(fitnesses + batches[batch].begin) + offset;
+			size = payloadSize - offset;
+		}
+		ssize_t received = read(worker.socket, data, size);
+		if (received < 0 && errno == EINTR) continue;
+		if (received < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+		if (received == 0) return false;
+		worker.receiveOffset += received;
+		if (worker.receiveOffset == sizeof(MessageHeader) && (worker.reply.magic != messageMagic || worker.reply.type != FitnessMessage
+			|| (int)worker.reply.batch != batch || (int)worker.reply.count != count))
+		{
+			return false;
+		}
+		if (worker.receiveOffset == sizeof(MessageHeader) + payloadSize)
+		{
+			worker.batches.pop_front();
+			worker.sentBatches--;
+			worker.receiveOffset = 0;
+			worker.deadline = getBatchDeadline();
+		}
+	}
+	return true;
+}
+
+/*
+Evaluates count genomes (genomeStride floats apart) on the track with the given id and with
+the given termination policy using the workers, writing a fitness for each one. Batches are
+handed out whenever a worker has room, and requests are sent and results collected as each
+socket becomes ready. Anything left when no workers remain is evaluated by the coordinator
+*/
+void Coordinator::evaluate(int caseId, const TerminationPolicy &policy, const float *genomes, int genomeStride, int count, float *fitnesses)
+{
+	this->caseId = caseId;
+	this->policy = policy;
+	this->genomes = genomes;
+	this->genomeStride = genomeStride;
+	this->fitnesses = fitnesses;
+	batches.clear();
+	std::deque<int> pending;
+	for (int begin = 0; begin < count; begin += batchSize)
+	{
+		pending.push_back(batches.size());
+		batches.push_back({ begin, std::min(count, begin + batchSize) });
+	}
+	while (true)
+	{
+		bool anyInFlight = false;
+		bool anyWorker = false;
+		for (Worker &worker : workers)
+		{
+			while (worker.socket >= 0 && !pending.empty() && (int)worker.batches.size() < maxBatchesInFlight)
+			{
+				if (worker.batches.empty())
+				{
+					worker.deadline = getBatchDeadline();
+				}
+				worker.batches.push_back(pending.front());
+				pending.pop_front();
+			}
+			anyWorker = anyWorker || worker.socket >= 0;
+			anyInFlight = anyInFlight || !worker.batches.empty();
+		}
+		if (!anyWorker)
+		{
+			for (int batch : pending)
+			{
+				evaluateGenomes(cases[caseId], policy, genomes + (size_t)batches[batch].begin * genomeStride, genomeStride,
+					batches[batch].end - batches[batch].begin, fitnesses + batches[batch].begin);
+			}
+			return;
+		}
+		if (!anyInFlight)
+		{
+			return;
+		}
+		// Polling stops at the earliest deadline so a worker which never replies is noticed
+		int timeout = -1;
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		for (int i = 0; i < (int)workers.size(); i++)
+		{
+			Worker &worker = workers[i];
+			if (batchTimeout > 0 && !worker.batches.empty())
+			{
+				long long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(worker.deadline - now).count() + 1;
+				remaining = std::max(0LL, std::min(remaining, (long long)INT_MAX));
+				if (timeout < 0 || remaining < timeout)
+				{
+					timeout = (int)remaining;
+				}
+			}
+			short events = (worker.batches.empty() ? 0 : POLLIN) | (worker.sentBatches < (int)worker.batches.size() ? POLLOUT : 0);
+			pollSockets[i].fd = worker.socket;
+			pollSockets[i].events = events;
+			pollSockets[i].revents = 0;
+		}
+		if (poll(pollSockets.data(), pollSockets.size(), timeout) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			// Nothing can be heard from the workers, so their batches are handed out again like those of dead workers
+			std::cerr << "Polling the workers failed: " << std::strerror(errno) << '\n';
+			for (Worker &worker : workers)
+			{
+				if (worker.socket >= 0 && !worker.batches.empty())
+				{
+					failWorker(worker, pending);
+				}
+			}
+			continue;
+		}
+		for (int i = 0; i < (int)workers.size(); i++)
+		{
+			Worker &worker = workers[i];
+			short events = pollSockets[i].revents;
+			if (worker.socket < 0 || !events)
+			{
+				continue;
+			}
+			// A worker which hangs up or errors can still have replies waiting to be read
+			bool working = !(events & POLLOUT) || sendRequests(worker);
+			if (working && (events & (POLLIN | POLLHUP | POLLERR | POLLNVAL)))
+			{
+				working = receiveReplies(worker) && (worker.batches.empty() || !(events & (POLLHUP | POLLERR | POLLNVAL)));
+			}
+			if (!working)
+			{
+				failWorker(worker, pending);
+			}
+		}
+		now = std::chrono::steady_clock::now();
+		for (Worker &worker : workers)
+		{
+			if (batchTimeout > 0 && worker.socket >= 0 && !worker.batches.empty() && now >= worker.deadline)
+			{
+				std::cerr << "Worker " << &worker - workers.data() << " took over " << batchTimeout << "s on a batch\n";
+				failWorker(worker, pending);
+			}
+		}
+	}
+}
+
+/*
+Sets how many seconds a worker may take over a batch, counted from when it could start on
+it, before it's treated as having failed. 0 waits for as long as it takes
+*/
+void Coordinator::setBatchTimeout(double batchTimeout)
+{
+	this->batchTimeout = std::max(batchTimeout, 0.0);
+}
+
+// The deadline for the reply to a batch a worker can start on now
+std::chrono::steady_clock::time_point Coordinator::getBatchDeadline()
+{
+	return std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(batchTimeout));
+}
+
+// Number of workers which are running
+int Coordinator::getNumberWorkers()
+{
+	int numberWorkers = 0;
+	for (Worker &worker : workers)
+	{
+		numberWorkers += worker.socket >= 0;
+	}
+	return numberWorkers;
+}
+
+// Getter
+int Coordinator::getNumberRestarts()
+{
+	return numberRestarts;
+}
+
+/*
+The worker's loop, which evaluates each batch it is sent in turn and replies with the
+fitnesses. It exits without returning when told to shut down or when the coordinator goes
+away, so nothing the coordinator set up is torn down twice
+*/
+void runWorker(int socket, const std::vector<EvaluationCase> &cases)
+{
+	std::vector<float> genomes;
+	std::vector<float> fitnesses;
+	MessageHeader header;
+	while (readAll(socket, &header, sizeof(header)) && header.magic == messageMagic && header.type == EvaluateMessage
+		&& header.caseId < cases.size() && header.count <= (uint32_t)maxBatchSize)
+	{
+		genomes.resize((size_t)header.count * header.genomeStride);
+		fitnesses.resize(header.count);
+		if (!readAll(socket, genomes.data(), genomes.size() * sizeof(float)))
+		{
+			break;
+		}
+		TerminationPolicy policy = { (int)header.maxTicks, (int)header.stallTicks, (int)header.laps };
+		evaluateGenomes(cases[header.caseId], policy, genomes.data(), header.genomeStride, header.count, fitnesses.data());
+		MessageHeader reply = { 0, FitnessMessage, header.batch, header.caseId, header.count, 0, 0, 0, 0 };
+		if (!sendMessage(socket, reply, fitnesses.data(), fitnesses.size()))
+		{
+			break;
+		}
+	}
+	_exit(0);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "Agent.h"
+#include "Evaluation.h"
+
+// Worker processes talk over Unix domain sockets so they are only available on POSIX systems
+#if defined(__unix__) || defined(__APPLE__)
+#define DISTRIBUTED_EVALUATION 1
+#include <poll.h>
+#include <sys/types.h>
+#else
+#define DISTRIBUTED_EVALUATION 0
+#endif
+
+#if DISTRIBUTED_EVALUATION
+/*
+Every message is a header followed by its payload. An evaluation request carries count
+genomes, genomeStride floats apart, to run on the evaluation case with the given id and its result
+carries one fitness per genome. A request also carries the termination policy to run the
+agents with. Values are sent in the machine's own byte order
+*/
+struct MessageHeader
+{
+	uint32_t magic;
+	uint32_t type;
+	uint32_t batch;
+	uint32_t caseId;
+	uint32_t count;
+	uint32_t genomeStride;
+	uint32_t maxTicks;
+	uint32_t stallTicks;
+	uint32_t laps;
+};
+
+enum MessageType
+{
+	EvaluateMessage = 1,
+	FitnessMessage = 2,
+	ShutdownMessage = 3
+};
+
+// The most genomes a batch may hold, which keeps a message's payload within reason
+const int maxBatchSize = 1 << 20;
+
+/*
+Farms the evaluation of genomes out to worker processes. The genomes of a generation are cut
+into batches of many genomes per message and each worker is given at most a fixed number of
+batches at a time, so a slow worker holds back only its own work. The coordinator's ends of
+the sockets don't block: requests are written as far as the socket takes them while replies
+are read as they arrive, so neither side can be left waiting on the other to read. If a
+worker dies, or takes longer than the batch timeout over a batch, its batches are handed to
+the others and it is replaced by a spare, and a batch which keeps failing is evaluated by the
+coordinator itself. Workers and spares are all forked when the coordinator is constructed, so
+its process must not have started any other threads by then, and share its cases
+*/
+class Coordinator
+{
+public:
+	Coordinator(std::vector<EvaluationCase>, int, int = 64, int = 2);
+	~Coordinator();
+
+	void evaluate(int, const TerminationPolicy&, const float*, int, int, float*);
+
+	void setBatchTimeout(double);
+
+	int getNumberWorkers();
+
+	int getNumberRestarts();
+
+private:
+	/*
+	A worker's batches are in the order they're sent in. The first sentBatches of them have
+	been written in full and the next has been written up to sendOffset bytes of its request,
+	while the reply to the first has been read up to receiveOffset bytes. The worker fails if
+	the reply to the first hasn't arrived by the deadline
+	*/
+	struct Worker
+	{
+		int socket = -1;
+		pid_t process = -1;
+		std::deque<int> batches;
+		int sentBatches = 0;
+		size_t sendOffset = 0;
+		MessageHeader request;
+		size_t receiveOffset = 0;
+		MessageHeader reply;
+		std::chrono::steady_clock::time_point deadline;
+	};
+
+	struct Batch
+	{
+		int begin;
+		int end;
+		int attempts = 0;
+	};
+
+	bool startWorker(Worker&);
+
+	void stopWorker(Worker&);
+
+	void failWorker(Worker&, std::deque<int>&);
+
+	bool sendRequests(Worker&);
+
+	bool receiveReplies(Worker&);
+
+	std::chrono::steady_clock::time_point getBatchDeadline();
+
+	std::vector<EvaluationCase> cases;
+	std::vector<Worker> workers;
+	// One entry per worker, reused by every poll
+	std::vector<pollfd> pollSockets;
+	int batchSize;
+	int maxBatchesInFlight;
+	const int maxAttempts = 3;
+	// Idle workers forked up front to replace those which fail
+	std::vector<Worker> spares;
+	int numberRestarts = 0;
+	double batchTimeout = 300;
+
+	// The generation currently being evaluated
+	std::vector<Batch> batches;
+	int caseId = 0;
+	TerminationPolicy policy;
+	const float *genomes = nullptr;
+	int genomeStride = 0;
+	float *fitnesses = nullptr;
+};
+
+void runWorker(int, const std::vector<EvaluationCase>&);
+#endif
\ No newline at end of file
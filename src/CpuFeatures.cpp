@@ -0,0 +1,46 @@
+#include "CpuFeatures.h"
+#if defined(_MSC_VER) && SIMD_KERNELS
+#include <intrin.h>
+#endif
+
+#if defined(_MSC_VER) && SIMD_KERNELS
+// Checks a feature bit of cpuid leaf 7 and that the OS saves the matching register state
+static bool checkCpuid(int bit, unsigned long long osMask)
+{
+	int registers[4];
+	__cpuid(registers, 1);
+	// OSXSAVE must be set for xgetbv to be available
+	if (!(registers[2] & (1 << 27)))
+	{
+		return false;
+	}
+	if ((_xgetbv(0) & osMask) != osMask)
+	{
+		return false;
+	}
+	__cpuidex(registers, 7, 0);
+	return (registers[1] & (1 << bit)) != 0;
+}
+#endif
+
+bool cpuSupportsAvx2()
+{
+#if defined(__GNUC__) && SIMD_KERNELS
+	return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER) && SIMD_KERNELS
+	return checkCpuid(5, 0x6);
+#else
+	return false;
+#endif
+}
+
+bool cpuSupportsAvx512()
+{
+#if defined(__GNUC__) && SIMD_KERNELS
+	return __builtin_cpu_supports("avx512f");
+#elif defined(_MSC_VER) && SIMD_KERNELS
+	return checkCpuid(16, 0xe6);
+#else
+	return false;
+#endif
+}
\ No newline at end of file
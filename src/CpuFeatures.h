@@ -0,0 +1,34 @@
+#pragma once
+
+/*
+Runtime detection of the instruction sets the SIMD kernels can use. Kernels are compiled for
+every instruction set up front and one is picked when the program runs, so a single binary
+works on any x86-64 machine and uses the widest vectors it has
+*/
+bool cpuSupportsAvx2();
+
+bool cpuSupportsAvx512();
+
+/*
+Kernels are marked with the instruction set they need rather than relying on compiler flags.
+GCC would otherwise fuse separate multiplies and adds into FMA instructions under AVX-512,
+which changes rounding and would stop kernels matching their scalar equivalents bit for bit
+*/
+#if defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_KERNELS 1
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2")))
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_KERNELS 1
+#define TARGET_AVX2 __attribute__((target("avx2"), optimize("fp-contract=off")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2"), optimize("fp-contract=off")))
+// GCC's AVX-512 intrinsics trip a false positive on the deliberately undefined vectors they use
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define SIMD_KERNELS 1
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#define SIMD_KERNELS 0
+#endif
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cmath>
+#include "Diversity.h"
+
+DiversityMeter::DiversityMeter()
+{
+}
+
+/*
+Measures count agents with the given genomes (genomeStride floats apart), of which the first
+numberWeights floats are weights. A population of fewer than two agents has no diversity
+*/
+DiversityStatistics DiversityMeter::measure(DiversityMode mode, GeneticsKernel kernel, const float *genomes, int genomeStride,
+	int numberWeights, int count, Random &random, ThreadPool &threadPool)
+{
+	if (count < 2)
+	{
+		return { 0.0, 0.0, 0.0 };
+	}
+	this->mode = mode;
+	this->genomes = genomes;
+	this->genomeStride = genomeStride;
+	this->count = count;
+	columns.resize((size_t)numberWeights * count);
+	weightDistances.assign(numberWeights, 0.0);
+	weightVariances.assign(numberWeights, 0.0);
+	weightDeviations.assign(numberWeights, 0.0);
+	threadPool.parallelFor(numberWeights, weightsPerChunk, [this](int begin, int end, int)
+	{
+		measureWeights(begin, end);
+	});
+	DiversityStatistics statistics = { 0.0, 0.0, 0.0 };
+	for (int weight = 0; weight < numberWeights; weight++)
+	{
+		statistics.meanDistance += weightDistances[weight];
+		statistics.weightVariance += weightVariances[weight];
+		statistics.centroidDistance += weightDeviations[weight];
+	}
+	statistics.weightVariance /= numberWeights;
+	if (mode != SampledDiversity)
+	{
+		statistics.meanDistance /= (double)count * (count - 1) / 2;
+		return statistics;
+	}
+	// Each sample is a pair of different agents, as the exact mean is over those
+	statistics.meanDistance = 0.0;
+	for (int sample = 0; sample < numberSamples; sample++)
+	{
+		int agent1 = random.nextInt(count);
+		int agent2 = random.nextInt(count - 1);
+		if (agent2 >= agent1)
+		{
+			agent2++;
+		}
+		statistics.meanDistance += geneticDiversity(kernel, genomes + (size_t)agent1 * genomeStride, genomes + (size_t)agent2 * genomeStride,
+			numberWeights);
+	}
+	statistics.meanDistance /= numberSamples;
+	return statistics;
+}
+
+/*
+Gathers the values of the weights in [begin, end) into their columns and works out each
+weight's share of the statistics: the sum of the differences between every pair of agents
+(found from the sorted column in the exact mode), the variance and the mean absolute
+deviation from the mean, which summed over the weights is the mean distance from the centroid
+*/
+void DiversityMeter::measureWeights(int begin, int end)
+{
+	for (int agent = 0; agent < count; agent++)
+	{
+		const float *genome = genomes + (size_t)agent * genomeStride;
+		for (int weight = begin; weight < end; weight++)
+		{
+			columns[(size_t)weight * count + agent] = genome[weight];
+		}
+	}
+	for (int weight = begin; weight < end; weight++)
+	{
+		float *column = columns.data() + (size_t)weight * count;
+		double sum = 0.0;
+		for (int agent = 0; agent < count; agent++)
+		{
+			sum += column[agent];
+		}
+		double mean = sum / count;
+		double squaredDeviations = 0.0;
+		double absoluteDeviations = 0.0;
+		for (int agent = 0; agent < count; agent++)
+		{
+			double deviation = column[agent] - mean;
+			squaredDeviations += deviation * deviation;
+			absoluteDeviations += std::abs(deviation);
+		}
+		weightVariances[weight] = squaredDeviations / count;
+		weightDeviations[weight] = absoluteDeviations / count;
+		if (mode == ExactDiversity)
+		{
+			std::sort(column, column + count);
+			double pairwiseDifferences = 0.0;
+			for (int rank = 0; rank < count; rank++)
+			{
+				pairwiseDifferences += (double)(2 * rank - count + 1) * column[rank];
+			}
+			weightDistances[weight] = pairwiseDifferences;
+		}
+	}
+}
+
+const char *getDiversityModeName(DiversityMode mode)
+{
+	switch (mode)
+	{
+	case ExactDiversity:
+		return "exact";
+	case SampledDiversity:
+		return "sampled";
+	}
+	return "unknown";
+}
+
+// Looks up a mode by the name getDiversityModeName gives it
+bool parseDiversityMode(std::string name, DiversityMode &mode)
+{
+	for (DiversityMode candidate : { ExactDiversity, SampledDiversity })
+	{
+		if (name == getDiversityModeName(candidate))
+		{
+			mode = candidate;
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
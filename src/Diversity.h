@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Genetics.h"
+#include "Random.h"
+#include "ThreadPool.h"
+
+enum DiversityMode
+{
+	ExactDiversity,
+	SampledDiversity
+};
+
+/*
+How spread out a population's genomes are: the mean L1 distance between two different
+agents (the diversity), the variance of each weight across the population averaged over the
+weights and the mean L1 distance of an agent from the centroid (the mean genome)
+*/
+struct DiversityStatistics
+{
+	double meanDistance;
+	double weightVariance;
+	double centroidDistance;
+};
+
+/*
+Measures the diversity of flat genome buffers. The exact mode finds the mean distance over
+every pair of agents without comparing any pairs: for each weight the values are sorted, and
+the k-th smallest of N is larger than k values and smaller than N - 1 - k, so it adds
+(2k - N + 1) times its value to the sum of the pairwise differences. This costs O(N log N) per
+weight rather than O(N^2). The sampled mode estimates the mean distance from a fixed number
+of random pairs of different agents with the SIMD diversity kernel, for when even sorting
+every weight is too slow. Both work out the variance and centroid distance exactly in a
+single pass. Weights are measured in parallel in groups whose results are added up in order,
+so the statistics don't depend on the number of threads. The columns are kept between calls
+so measuring allocates nothing once they have grown
+*/
+class DiversityMeter
+{
+public:
+	DiversityMeter();
+
+	DiversityStatistics measure(DiversityMode, GeneticsKernel, const float*, int, int, int, Random&, ThreadPool&);
+
+private:
+	void measureWeights(int, int);
+
+	// The measurement under way, kept here so the parallel loop only captures the meter
+	DiversityMode mode = ExactDiversity;
+	const float *genomes = nullptr;
+	int genomeStride = 0;
+	int count = 0;
+
+	// One column of every agent's value for each weight and the sums of each weight's measures
+	std::vector<float> columns;
+	std::vector<double> weightDistances;
+	std::vector<double> weightVariances;
+	std::vector<double> weightDeviations;
+	const int numberSamples = 1000;
+	const int weightsPerChunk = 8;
+};
+
+const char *getDiversityModeName(DiversityMode);
+
+bool parseDiversityMode(std::string, DiversityMode&);
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include "Evaluation.h"
+
+// The case of starting on a track from the pose given in its map
+EvaluationCase makeEvaluationCase(std::shared_ptr<const Track> track)
+{
+	return { track, track->getStartingPosition(), track->getStartingAngle() };
+}
+
+/*
+Combines the fitnesses of count agents on each of a number of cases into one fitness each.
+The fitnesses on a case are stored together (case major), as the cases are evaluated one at
+a time. The mean rewards doing well on average while the minimum only rewards genomes which
+do well on every case. Cases are added in order so the result is always the same
+*/
+void aggregateFitness(FitnessAggregation aggregation, const float *caseFitness, int numberCases, int count, float *fitness)
+{
+	for (int agent = 0; agent < count; agent++)
+	{
+		float combined = caseFitness[agent];
+		for (int evaluationCase = 1; evaluationCase < numberCases; evaluationCase++)
+		{
+			float current = caseFitness[(size_t)evaluationCase * count + agent];
+			combined = aggregation == MinFitness ? std::min(combined, current) : combined + current;
+		}
+		fitness[agent] = aggregation == MinFitness ? combined : combined / numberCases;
+	}
+}
+
+const char *getFitnessAggregationName(FitnessAggregation aggregation)
+{
+	switch (aggregation)
+	{
+	case MeanFitness:
+		return "mean";
+	case MinFitness:
+		return "min";
+	}
+	return "unknown";
+}
+
+// Looks up an aggregation by the name getFitnessAggregationName gives it
+bool parseFitnessAggregation(std::string name, FitnessAggregation &aggregation)
+{
+	for (FitnessAggregation candidate : { MeanFitness, MinFitness })
+	{
+		if (name == getFitnessAggregationName(candidate))
+		{
+			aggregation = candidate;
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
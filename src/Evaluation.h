@@ -0,0 +1,31 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "Geometry.h"
+#include "Track.h"
+
+enum FitnessAggregation
+{
+	MeanFitness,
+	MinFitness
+};
+
+/*
+One of the cases a genome is evaluated on: a track and the pose its agents start from. A
+genome scored on several tracks and poses can't overfit any one of them. The track is shared
+by every case and simulation using it, so a case costs nothing per agent
+*/
+struct EvaluationCase
+{
+	std::shared_ptr<const Track> track;
+	Vector2 startingPosition;
+	int startingAngle;
+};
+
+EvaluationCase makeEvaluationCase(std::shared_ptr<const Track>);
+
+void aggregateFitness(FitnessAggregation, const float*, int, int, float*);
+
+const char *getFitnessAggregationName(FitnessAggregation);
+
+bool parseFitnessAggregation(std::string, FitnessAggregation&);
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+/*
+A matrix whose dimensions are known at compile time. The data is stored inline so it never
+touches the heap, and the loop bounds of the multiplication are constants which lets the
+compiler unroll it completely. The arithmetic is done in the same order as Matrix so both
+give identical results
+*/
+template<int Rows, int Columns>
+class FixedMatrix
+{
+public:
+	constexpr FixedMatrix()
+		: matrixData{}
+	{
+	}
+
+	// Copies the data from a row major array
+	constexpr explicit FixedMatrix(const float *data)
+		: matrixData{}
+	{
+		for (int i = 0; i < Rows * Columns; i++)
+		{
+			matrixData[i] = data[i];
+		}
+	}
+
+	constexpr float operator()(int row, int column) const
+	{
+		return matrixData[row * Columns + column];
+	}
+
+	constexpr void setData(int row, int column, float data)
+	{
+		matrixData[row * Columns + column] = data;
+	}
+
+	template<int OtherColumns>
+	constexpr FixedMatrix<Rows, OtherColumns> operator*(const FixedMatrix<Columns, OtherColumns> &otherMatrix) const
+	{
+		FixedMatrix<Rows, OtherColumns> result;
+		for (int row = 0; row < Rows; row++)
+		{
+			for (int column = 0; column < OtherColumns; column++)
+			{
+				float dotProduct = 0;
+				for (int k = 0; k < Columns; k++)
+				{
+					dotProduct += (*this)(row, k) * otherMatrix(k, column);
+				}
+				result.setData(row, column, dotProduct);
+			}
+		}
+		return result;
+	}
+
+private:
+	float matrixData[Rows * Columns];
+};
+
+/*
+Evaluates the layers of a FixedNetwork, with each layer's weights read from the genome as a
+row major matrix and the sigmoid applied to every node
+*/
+template<int Inputs, int Outputs, int... Rest>
+struct FixedLayers
+{
+	template<typename Activation>
+	static auto forward(const FixedMatrix<1, Inputs> &input, const float *genome, Activation activation)
+	{
+		return FixedLayers<Outputs, Rest...>::forward(FixedLayers<Inputs, Outputs>::forward(input, genome, activation),
+			genome + Inputs * Outputs, activation);
+	}
+};
+
+template<int Inputs, int Outputs>
+struct FixedLayers<Inputs, Outputs>
+{
+	template<typename Activation>
+	static FixedMatrix<1, Outputs> forward(const FixedMatrix<1, Inputs> &input, const float *genome, Activation activation)
+	{
+		FixedMatrix<1, Outputs> output = input * FixedMatrix<Inputs, Outputs>(genome);
+		for (int node = 0; node < Outputs; node++)
+		{
+			output.setData(0, node, activation(output(0, node)));
+		}
+		return output;
+	}
+};
+
+// A fully connected network whose layer sizes are fixed at compile time
+template<int... LayerSizes>
+struct FixedNetwork
+{
+	static constexpr int layerSizes[] = { LayerSizes... };
+	static constexpr int numberLayers = sizeof...(LayerSizes);
+	static constexpr int numberInputs = layerSizes[0];
+	static constexpr int numberOutputs = layerSizes[numberLayers - 1];
+
+	// Feeds the inputs, which are read with the given stride, through the network
+	template<typename Activation>
+	static FixedMatrix<1, numberOutputs> forward(const float *inputs, int inputStride, const float *genome, Activation activation)
+	{
+		FixedMatrix<1, numberInputs> input;
+		for (int node = 0; node < numberInputs; node++)
+		{
+			input.setData(0, node, inputs[node * inputStride]);
+		}
+		return FixedLayers<LayerSizes...>::forward(input, genome, activation);
+	}
+};
\ No newline at end of file
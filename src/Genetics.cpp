@@ -0,0 +1,492 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "CpuFeatures.h"
+#include "Genetics.h"
+#if SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+/*
+Eight xoshiro256** streams seeded from the caller's generator and stepped together. Step s
+writes the next number of stream l to bits[s * 8 + l], which the SIMD kernels do with one
+stream per 64 bit lane. The state is stored one word of every stream after another
+*/
+struct RandomLanes
+{
+	uint64_t state[4][8];
+
+	RandomLanes(Random &random)
+	{
+		for (int word = 0; word < 4; word++)
+		{
+			for (int lane = 0; lane < 8; lane++)
+			{
+				state[word][lane] = random.nextBits();
+			}
+		}
+	}
+};
+
+// Weights are processed in blocks so the random words for a block fit on the stack
+static const int blockSize = 128;
+
+static uint64_t rotateLeft(uint64_t value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+static void fillBitsScalar(RandomLanes &lanes, uint64_t *bits, int steps)
+{
+	for (int step = 0; step < steps; step++)
+	{
+		for (int lane = 0; lane < 8; lane++)
+		{
+			uint64_t *s0 = &lanes.state[0][lane], *s1 = &lanes.state[1][lane], *s2 = &lanes.state[2][lane], *s3 = &lanes.state[3][lane];
+			bits[step * 8 + lane] = rotateLeft(*s1 * 5, 7) * 9;
+			uint64_t shifted = *s1 << 17;
+			*s2 ^= *s0;
+			*s3 ^= *s1;
+			*s1 ^= *s2;
+			*s0 ^= *s3;
+			*s2 ^= shifted;
+			*s3 = rotateLeft(*s3, 45);
+		}
+	}
+}
+
+/*
+Where each random word's top 24 bits, as a fraction of 2^24, are below the threshold the
+weight is replaced by a * weight + b * value + c, where value is the fraction given by the
+matching word of values
+*/
+static void blendMutationsScalar(float *genomes, const uint32_t *chances, const uint32_t *values, int count, uint32_t threshold, float a, float b, float c)
+{
+	for (int i = 0; i < count; i++)
+	{
+		float value = (float)(values[i] >> 8) * (1.0f / 16777216.0f);
+		float mutated = a * genomes[i] + b * value + c;
+		genomes[i] = (chances[i] >> 8) < threshold ? mutated : genomes[i];
+	}
+}
+
+// Takes each weight from parent 1 where the top bit of its random word is set
+static void blendParentsScalar(const float *parent1, const float *parent2, const uint32_t *choices, float *child, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		child[i] = (choices[i] >> 31) ? parent1[i] : parent2[i];
+	}
+}
+
+// Adds the absolute differences from the first weight given on to the partial sums, then totals them in order
+static double finishDiversity(const float *genome1, const float *genome2, int first, int numberWeights, double *partialSums)
+{
+	for (int weight = first; weight < numberWeights; weight++)
+	{
+		float weightDifference = genome1[weight] - genome2[weight];
+		partialSums[weight % 8] += std::abs(weightDifference);
+	}
+	double diversity = 0.0;
+	for (int lane = 0; lane < 8; lane++)
+	{
+		diversity += partialSums[lane];
+	}
+	return diversity;
+}
+
+/*
+Sums the absolute differences between two genomes into eight partial sums, one for every
+eighth weight, which are added up in order at the end. The SIMD kernels keep the same partial
+sums in their lanes so every kernel gives the same result
+*/
+static double diversityScalar(const float *genome1, const float *genome2, int numberWeights)
+{
+	double partialSums[8] = {};
+	return finishDiversity(genome1, genome2, 0, numberWeights, partialSums);
+}
+
+#if SIMD_KERNELS
+TARGET_AVX2 static __m256i rotateLeft256(__m256i value, int bits)
+{
+	return _mm256_or_si256(_mm256_slli_epi64(value, bits), _mm256_srli_epi64(value, 64 - bits));
+}
+
+// Two vectors hold the eight streams, four to a vector. Multiplying by 5 and 9 is done with shifts
+TARGET_AVX2 static void fillBitsAvx2(RandomLanes &lanes, uint64_t *bits, int steps)
+{
+	for (int half = 0; half < 2; half++)
+	{
+		__m256i s0 = _mm256_loadu_si256((const __m256i*)&lanes.state[0][half * 4]);
+		__m256i s1 = _mm256_loadu_si256((const __m256i*)&lanes.state[1][half * 4]);
+		__m256i s2 = _mm256_loadu_si256((const __m256i*)&lanes.state[2][half * 4]);
+		__m256i s3 = _mm256_loadu_si256((const __m256i*)&lanes.state[3][half * 4]);
+		for (int step = 0; step < steps; step++)
+		{
+			__m256i times5 = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+			__m256i rotated = rotateLeft256(times5, 7);
+			__m256i result = _mm256_add_epi64(_mm256_slli_epi64(rotated, 3), rotated);
+			_mm256_storeu_si256((__m256i*)(bits + step * 8 + half * 4), result);
+			__m256i shifted = _mm256_slli_epi64(s1, 17);
+			s2 = _mm256_xor_si256(s2, s0);
+			s3 = _mm256_xor_si256(s3, s1);
+			s1 = _mm256_xor_si256(s1, s2);
+			s0 = _mm256_xor_si256(s0, s3);
+			s2 = _mm256_xor_si256(s2, shifted);
+			s3 = rotateLeft256(s3, 45);
+		}
+		_mm256_storeu_si256((__m256i*)&lanes.state[0][half * 4], s0);
+		_mm256_storeu_si256((__m256i*)&lanes.state[1][half * 4], s1);
+		_mm256_storeu_si256((__m256i*)&lanes.state[2][half * 4], s2);
+		_mm256_storeu_si256((__m256i*)&lanes.state[3][half * 4], s3);
+	}
+}
+
+TARGET_AVX2 static void blendMutationsAvx2(float *genomes, const uint32_t *chances, const uint32_t *values, int count, uint32_t threshold, float a, float b, float c)
+{
+	__m256 scale = _mm256_set1_ps(1.0f / 16777216.0f);
+	__m256i limit = _mm256_set1_epi32((int)threshold);
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 value = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(_mm256_loadu_si256((const __m256i*)(values + i)), 8)), scale);
+		__m256 genome = _mm256_loadu_ps(genomes + i);
+		__m256 mutated = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(a), genome), _mm256_mul_ps(_mm256_set1_ps(b), value)), _mm256_set1_ps(c));
+		// The shifted words are below 2^24 so a signed comparison works
+		__m256i chance = _mm256_srli_epi32(_mm256_loadu_si256((const __m256i*)(chances + i)), 8);
+		__m256 mask = _mm256_castsi256_ps(_mm256_cmpgt_epi32(limit, chance));
+		_mm256_storeu_ps(genomes + i, _mm256_blendv_ps(genome, mutated, mask));
+	}
+	blendMutationsScalar(genomes + i, chances + i, values + i, count - i, threshold, a, b, c);
+}
+
+TARGET_AVX2 static void blendParentsAvx2(const float *parent1, const float *parent2, const uint32_t *choices, float *child, int count)
+{
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 choice = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(choices + i)));
+		_mm256_storeu_ps(child + i, _mm256_blendv_ps(_mm256_loadu_ps(parent2 + i), _mm256_loadu_ps(parent1 + i), choice));
+	}
+	blendParentsScalar(parent1 + i, parent2 + i, choices + i, child + i, count - i);
+}
+
+// One vector holds all eight streams
+TARGET_AVX512 static void fillBitsAvx512(RandomLanes &lanes, uint64_t *bits, int steps)
+{
+	__m512i s0 = _mm512_loadu_si512(lanes.state[0]);
+	__m512i s1 = _mm512_loadu_si512(lanes.state[1]);
+	__m512i s2 = _mm512_loadu_si512(lanes.state[2]);
+	__m512i s3 = _mm512_loadu_si512(lanes.state[3]);
+	for (int step = 0; step < steps; step++)
+	{
+		__m512i rotated = _mm512_rol_epi64(_mm512_add_epi64(_mm512_slli_epi64(s1, 2), s1), 7);
+		_mm512_storeu_si512(bits + step * 8, _mm512_add_epi64(_mm512_slli_epi64(rotated, 3), rotated));
+		__m512i shifted = _mm512_slli_epi64(s1, 17);
+		s2 = _mm512_xor_si512(s2, s0);
+		s3 = _mm512_xor_si512(s3, s1);
+		s1 = _mm512_xor_si512(s1, s2);
+		s0 = _mm512_xor_si512(s0, s3);
+		s2 = _mm512_xor_si512(s2, shifted);
+		s3 = _mm512_rol_epi64(s3, 45);
+	}
+	_mm512_storeu_si512(lanes.state[0], s0);
+	_mm512_storeu_si512(lanes.state[1], s1);
+	_mm512_storeu_si512(lanes.state[2], s2);
+	_mm512_storeu_si512(lanes.state[3], s3);
+}
+
+TARGET_AVX512 static void blendMutationsAvx512(float *genomes, const uint32_t *chances, const uint32_t *values, int count, uint32_t threshold, float a, float b, float c)
+{
+	__m512 scale = _mm512_set1_ps(1.0f / 16777216.0f);
+	__m512i limit = _mm512_set1_epi32((int)threshold);
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m512 value = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(_mm512_loadu_si512(values + i), 8)), scale);
+		__m512 genome = _mm512_loadu_ps(genomes + i);
+		__m512 mutated = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(a), genome), _mm512_mul_ps(_mm512_set1_ps(b), value)), _mm512_set1_ps(c));
+		__mmask16 mask = _mm512_cmplt_epi32_mask(_mm512_srli_epi32(_mm512_loadu_si512(chances + i), 8), limit);
+		_mm512_storeu_ps(genomes + i, _mm512_mask_blend_ps(mask, genome, mutated));
+	}
+	blendMutationsScalar(genomes + i, chances + i, values + i, count - i, threshold, a, b, c);
+}
+
+TARGET_AVX512 static void blendParentsAvx512(const float *parent1, const float *parent2, const uint32_t *choices, float *child, int count)
+{
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__mmask16 choice = _mm512_cmplt_epi32_mask(_mm512_loadu_si512(choices + i), _mm512_setzero_si512());
+		_mm512_storeu_ps(child + i, _mm512_mask_blend_ps(choice, _mm512_loadu_ps(parent2 + i), _mm512_loadu_ps(parent1 + i)));
+	}
+	blendParentsScalar(parent1 + i, parent2 + i, choices + i, child + i, count - i);
+}
+
+TARGET_AVX2 static double diversityAvx2(const float *genome1, const float *genome2, int numberWeights)
+{
+	__m256 signMask = _mm256_set1_ps(-0.0f);
+	__m256d low = _mm256_setzero_pd();
+	__m256d high = _mm256_setzero_pd();
+	int weight = 0;
+	for (; weight + 8 <= numberWeights; weight += 8)
+	{
+		__m256 difference = _mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_loadu_ps(genome1 + weight), _mm256_loadu_ps(genome2 + weight)));
+		low = _mm256_add_pd(low, _mm256_cvtps_pd(_mm256_castps256_ps128(difference)));
+		high = _mm256_add_pd(high, _mm256_cvtps_pd(_mm256_extractf128_ps(difference, 1)));
+	}
+	double partialSums[8];
+	_mm256_storeu_pd(partialSums, low);
+	_mm256_storeu_pd(partialSums + 4, high);
+	return finishDiversity(genome1, genome2, weight, numberWeights, partialSums);
+}
+
+TARGET_AVX512 static double diversityAvx512(const float *genome1, const float *genome2, int numberWeights)
+{
+	__m512d sums = _mm512_setzero_pd();
+	int weight = 0;
+	for (; weight + 8 <= numberWeights; weight += 8)
+	{
+		__m256 difference = _mm256_sub_ps(_mm256_loadu_ps(genome1 + weight), _mm256_loadu_ps(genome2 + weight));
+		sums = _mm512_add_pd(sums, _mm512_abs_pd(_mm512_cvtps_pd(difference)));
+	}
+	double partialSums[8];
+	_mm512_storeu_pd(partialSums, sums);
+	return finishDiversity(genome1, genome2, weight, numberWeights, partialSums);
+}
+#endif
+
+/*
+Fills words with count random 32 bit words (count a multiple of 16), which are the 64 bit
+numbers of the streams split in two
+*/
+static void fillWords(GeneticsKernel kernel, RandomLanes &lanes, uint32_t *words, int count)
+{
+	uint64_t bits[blockSize];
+	switch (kernel)
+	{
+#if SIMD_KERNELS
+	case Avx2Genetics:
+		fillBitsAvx2(lanes, bits, count / 16);
+		break;
+	case Avx512Genetics:
+		fillBitsAvx512(lanes, bits, count / 16);
+		break;
+#endif
+	default:
+		fillBitsScalar(lanes, bits, count / 16);
+	}
+	std::memcpy(words, bits, count * sizeof(uint32_t));
+}
+
+static void blendMutations(GeneticsKernel kernel, float *genomes, const uint32_t *chances, const uint32_t *values, int count, uint32_t threshold, float a, float b, float c)
+{
+	switch (kernel)
+	{
+#if SIMD_KERNELS
+	case Avx2Genetics:
+		blendMutationsAvx2(genomes, chances, values, count, threshold, a, b, c);
+		break;
+	case Avx512Genetics:
+		blendMutationsAvx512(genomes, chances, values, count, threshold, a, b, c);
+		break;
+#endif
+	default:
+		blendMutationsScalar(genomes, chances, values, count, threshold, a, b, c);
+	}
+}
+
+static void blendParents(GeneticsKernel kernel, const float *parent1, const float *parent2, const uint32_t *choices, float *child, int count)
+{
+	switch (kernel)
+	{
+#if SIMD_KERNELS
+	case Avx2Genetics:
+		blendParentsAvx2(parent1, parent2, choices, child, count);
+		break;
+	case Avx512Genetics:
+		blendParentsAvx512(parent1, parent2, choices, child, count);
+		break;
+#endif
+	default:
+		blendParentsScalar(parent1, parent2, choices, child, count);
+	}
+}
+
+// Rounds a number of random words up to the 16 made by one step of the streams
+static int roundWords(int count)
+{
+	return (count + 15) / 16 * 16;
+}
+
+/*
+This will perform a genetic "crossover" for count children, the parents of child c being the
+genomes given by parents[2c] and parents[2c + 1]. For a layer crossover, a crossover point is
+randomly chosen for each layer in the parents' networks and the new weights consist of the
+weights from parent 1 before the crossover point and the weights from parent 2 after the
+crossover point. Children are written straight into children (genomeStride floats apart)
+which must not overlap the parents
+*/
+void crossBatch(GeneticsKernel kernel, const float *genomes, const int *parents, int count, float *children, int genomeStride, const std::vector<int> &networkArchitecture, CrossoverType type, Random &random)
+{
+	int numberWeights = 0;
+	for (int currentLayer = 0; currentLayer < (int)networkArchitecture.size() - 1; currentLayer++)
+	{
+		numberWeights += networkArchitecture[currentLayer] * networkArchitecture[currentLayer + 1];
+	}
+	RandomLanes lanes(random);
+	uint32_t choices[blockSize];
+	for (int currentChild = 0; currentChild < count; currentChild++)
+	{
+		const float *parent1 = genomes + (size_t)parents[2 * currentChild] * genomeStride;
+		const float *parent2 = genomes + (size_t)parents[2 * currentChild + 1] * genomeStride;
+		float *child = children + (size_t)currentChild * genomeStride;
+		if (type == UniformCrossover)
+		{
+			for (int first = 0; first < numberWeights; first += blockSize)
+			{
+				int blockWeights = std::min(blockSize, numberWeights - first);
+				fillWords(kernel, lanes, choices, roundWords(blockWeights));
+				blendParents(kernel, parent1 + first, parent2 + first, choices, child + first, blockWeights);
+			}
+		}
+		else if (type == SinglePointCrossover)
+		{
+			int crossoverPoint = random.nextInt(numberWeights);
+			std::copy(parent1, parent1 + crossoverPoint, child);
+			std::copy(parent2 + crossoverPoint, parent2 + numberWeights, child + crossoverPoint);
+		}
+		else
+		{
+			int first = 0;
+			for (int currentLayer = 0; currentLayer < (int)networkArchitecture.size() - 1; currentLayer++)
+			{
+				int layerWeights = networkArchitecture[currentLayer] * networkArchitecture[currentLayer + 1];
+				int crossoverPoint = first + random.nextInt(layerWeights);
+				std::copy(parent1 + first, parent1 + crossoverPoint, child + first);
+				std::copy(parent2 + crossoverPoint, parent2 + first + layerWeights, child + crossoverPoint);
+				first += layerWeights;
+			}
+		}
+		std::fill(child + numberWeights, child + genomeStride, 0.0f);
+	}
+}
+
+/*
+Mutates the first numberWeights weights of count genomes (genomeStride floats apart). The
+mutation rate is a percentage which indicates what percentage of weights (on average) will be
+mutated. A soft mutation alters a weight by a uniform delta in [-0.05, 0.05), a hard mutation
+rewrites it with a new random weight in [-1, 1) and a gaussian mutation alters it by a normally
+distributed delta with a standard deviation of 0.03
+*/
+void mutateBatch(GeneticsKernel kernel, float *genomes, int count, int genomeStride, int numberWeights, float mutationRate, MutationType type, Random &random)
+{
+	uint32_t threshold = (uint32_t)std::ceil(std::max(0.0f, std::min(mutationRate, 100.0f)) / 100 * 16777216.0);
+	RandomLanes lanes(random);
+	uint32_t chances[blockSize];
+	uint32_t values[blockSize];
+	for (int currentGenome = 0; currentGenome < count; currentGenome++)
+	{
+		float *genome = genomes + (size_t)currentGenome * genomeStride;
+		for (int first = 0; first < numberWeights; first += blockSize)
+		{
+			int blockWeights = std::min(blockSize, numberWeights - first);
+			fillWords(kernel, lanes, chances, roundWords(blockWeights));
+			fillWords(kernel, lanes, values, roundWords(blockWeights));
+			if (type == HardMutation)
+			{
+				blendMutations(kernel, genome + first, chances, values, blockWeights, threshold, 0.0f, 2.0f, -1.0f);
+			}
+			else if (type == SoftMutation)
+			{
+				blendMutations(kernel, genome + first, chances, values, blockWeights, threshold, 1.0f, 0.1f, -0.05f);
+			}
+			else
+			{
+				// Few weights are picked so the normal deltas are made one at a time with Box-Muller
+				for (int weight = 0; weight < blockWeights; weight++)
+				{
+					if ((chances[weight] >> 8) < threshold)
+					{
+						float uniform1 = (float)((values[weight] >> 8) + 1) * (1.0f / 16777216.0f);
+						float uniform2 = random.nextFloat();
+						genome[first + weight] += 0.03f * std::sqrt(-2.0f * std::log(uniform1)) * std::cos(6.2831853f * uniform2);
+					}
+				}
+			}
+		}
+	}
+}
+
+/*
+This implements a metric for measuring the genetic diversity between two agents
+which take the sum of differences for each weight
+*/
+double geneticDiversity(GeneticsKernel kernel, const float *genome1, const float *genome2, int numberWeights)
+{
+	switch (kernel)
+	{
+#if SIMD_KERNELS
+	case Avx2Genetics:
+		return diversityAvx2(genome1, genome2, numberWeights);
+	case Avx512Genetics:
+		return diversityAvx512(genome1, genome2, numberWeights);
+#endif
+	default:
+		return diversityScalar(genome1, genome2, numberWeights);
+	}
+}
+
+GeneticsKernel bestGeneticsKernel()
+{
+	if (isGeneticsKernelSupported(Avx512Genetics))
+	{
+		return Avx512Genetics;
+	}
+	if (isGeneticsKernelSupported(Avx2Genetics))
+	{
+		return Avx2Genetics;
+	}
+	return ScalarGenetics;
+}
+
+bool isGeneticsKernelSupported(GeneticsKernel kernel)
+{
+	switch (kernel)
+	{
+	case Avx2Genetics:
+		return SIMD_KERNELS && cpuSupportsAvx2();
+	case Avx512Genetics:
+		return SIMD_KERNELS && cpuSupportsAvx512() && cpuSupportsAvx2();
+	default:
+		return true;
+	}
+}
+
+const char *getGeneticsKernelName(GeneticsKernel kernel)
+{
+	switch (kernel)
+	{
+	case ScalarGenetics:
+		return "scalar";
+	case Avx2Genetics:
+		return "avx2";
+	case Avx512Genetics:
+		return "avx512";
+	}
+	return "unknown";
+}
+
+// Looks up a kernel by the name getGeneticsKernelName gives it
+bool parseGeneticsKernel(std::string name, GeneticsKernel &kernel)
+{
+	for (GeneticsKernel candidate : { ScalarGenetics, Avx2Genetics, Avx512Genetics })
+	{
+		if (name == getGeneticsKernelName(candidate))
+		{
+			kernel = candidate;
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
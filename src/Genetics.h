@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Random.h"
+
+enum GeneticsKernel
+{
+	ScalarGenetics,
+	Avx2Genetics,
+	Avx512Genetics
+};
+
+/*
+How a child's weights are taken from its two parents: from parent 1 before a random point in
+each layer and from parent 2 after it, the same with a single point over the whole genome, or
+from either parent at random for every weight
+*/
+enum CrossoverType
+{
+	LayerCrossover,
+	SinglePointCrossover,
+	UniformCrossover
+};
+
+/*
+How a weight picked for mutation is changed: by a small uniform delta, by replacing it with a
+new random weight or by a small normally distributed delta
+*/
+enum MutationType
+{
+	SoftMutation,
+	HardMutation,
+	GaussianMutation
+};
+
+/*
+Genetic operators which work directly on flat genome buffers (see Population.h) for a whole
+batch of children at once, so no network has to be copied to mutate, cross or compare agents.
+The random numbers they need are drawn eight streams at a time and the choices made with them
+are masked blends, both of which the SIMD kernels do a vector at a time. Every kernel gives
+exactly the same results
+*/
+void crossBatch(GeneticsKernel, const float*, const int*, int, float*, int, const std::vector<int>&, CrossoverType, Random&);
+
+void mutateBatch(GeneticsKernel, float*, int, int, int, float, MutationType, Random&);
+
+double geneticDiversity(GeneticsKernel, const float*, const float*, int);
+
+GeneticsKernel bestGeneticsKernel();
+
+bool isGeneticsKernelSupported(GeneticsKernel);
+
+const char *getGeneticsKernelName(GeneticsKernel);
+
+bool parseGeneticsKernel(std::string, GeneticsKernel&);
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include <cmath>
+#include "Geometry.h"
+
+#define PI 3.1415926536
+
+// Component-wise vector addition
+Vector2 operator+(Vector2 vector1, Vector2 vector2)
+{
+	return { vector1.x + vector2.x, vector1.y + vector2.y };
+}
+
+// Convert from degrees to radians
+float radians(float theta)
+{
+	return (PI / 180) * theta;
+}
+
+// Keeps a rotation in degrees in the range [0, 360) in the same way as sf::Transformable
+float wrapRotation(float angle)
+{
+	float rotation = std::fmod(angle, 360.0f);
+	if (rotation < 0)
+	{
+		rotation += 360.0f;
+	}
+	return rotation;
+}
+
+// Find intersection point between two line segments from their start and end coordinates
+intersectionPoint checkIntersection(Vector2 line1Start, Vector2 line1End, Vector2 line2Start, Vector2 line2End)
+{
+	float deltaLine1X = line1Start.x - line1End.x;
+	float deltaLine2X = line2Start.x - line2End.x;
+	float deltaLine1Y = line1Start.y - line1End.y;
+	float deltaLine2Y = line2Start.y - line2End.y;
+	float denominator = deltaLine1X * deltaLine2Y - deltaLine1Y * deltaLine2X;
+	// Handle parallel lines
+	if (denominator == 0)
+	{
+		return { 0, 0 };
+	}
+	// Proportion along line1 point of intersection is
+	float lambda = ((line1Start.x - line2Start.x) * deltaLine2Y - (line1Start.y - line2Start.y) * deltaLine2X) / denominator;
+	// Proportion along line2 point of intersection is
+	float mu = -(deltaLine1X * (line1Start.y - line2Start.y) - deltaLine1Y * (line1Start.x - line2Start.x)) / denominator;
+	return { lambda, mu };
+}
+
+// The start of a segment and its start minus its end, as used for line 1 of checkIntersection
+PreparedSegment prepareSegment(Segment segment)
+{
+	return { segment.start, { segment.start.x - segment.end.x, segment.start.y - segment.end.y } };
+}
+
+/*
+The same as checkIntersection with line 1 given as a prepared segment, which saves working
+out its deltas every time it is tested. The results are identical
+*/
+intersectionPoint checkIntersection(const PreparedSegment &line1, Vector2 line2Start, Vector2 line2End)
+{
+	float deltaLine1X = line1.delta.x;
+	float deltaLine2X = line2Start.x - line2End.x;
+	float deltaLine1Y = line1.delta.y;
+	float deltaLine2Y = line2Start.y - line2End.y;
+	float denominator = deltaLine1X * deltaLine2Y - deltaLine1Y * deltaLine2X;
+	// Handle parallel lines
+	if (denominator == 0)
+	{
+		return { 0, 0 };
+	}
+	float lambda = ((line1.start.x - line2Start.x) * deltaLine2Y - (line1.start.y - line2Start.y) * deltaLine2X) / denominator;
+	float mu = -(deltaLine1X * (line1.start.y - line2Start.y) - deltaLine1Y * (line1.start.x - line2Start.x)) / denominator;
+	return { lambda, mu };
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+struct Vector2
+{
+	float x;
+	float y;
+};
+
+Vector2 operator+(Vector2, Vector2);
+
+struct Segment
+{
+	Vector2 start;
+	Vector2 end;
+};
+
+// A segment with the deltas checkIntersection needs computed ahead of time
+struct PreparedSegment
+{
+	Vector2 start;
+	Vector2 delta;
+};
+
+PreparedSegment prepareSegment(Segment);
+
+struct intersectionPoint
+{
+	float lambda;
+	float mu;
+};
+
+float radians(float);
+
+float wrapRotation(float);
+
+intersectionPoint checkIntersection(Vector2, Vector2, Vector2, Vector2);
+
+intersectionPoint checkIntersection(const PreparedSegment&, Vector2, Vector2);
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+#include "Instrumentation.h"
+
+#if INSTRUMENTATION
+/*
+The counters of one thread. Only the thread itself adds to them, so relaxed loads and stores
+are enough and no two threads ever write to the same counter
+*/
+struct ThreadInstrumentation
+{
+	std::atomic<long long> nanoseconds[numberInstrumentationTimers];
+	std::atomic<long long> calls[numberInstrumentationTimers];
+	std::atomic<long long> counts[numberInstrumentationCounters];
+
+	ThreadInstrumentation();
+	~ThreadInstrumentation();
+};
+
+static void add(std::atomic<long long> &total, long long value)
+{
+	total.store(total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// Allocations are counted from operator new, which can't use the thread's counters while they're being set up
+static std::atomic<long long> allocationCount{ 0 };
+
+/*
+Function local so they exist before any thread's counters are, however static objects are
+initialised. The counters of threads which have finished are folded into the retired totals
+*/
+static std::mutex &getRegistryMutex()
+{
+	static std::mutex *registryMutex = new std::mutex;
+	return *registryMutex;
+}
+
+static std::vector<ThreadInstrumentation*> &getRegistry()
+{
+	static std::vector<ThreadInstrumentation*> *registry = new std::vector<ThreadInstrumentation*>;
+	return *registry;
+}
+
+static InstrumentationTotals &getRetiredTotals()
+{
+	static InstrumentationTotals retiredTotals = {};
+	return retiredTotals;
+}
+
+ThreadInstrumentation::ThreadInstrumentation()
+{
+	for (int timer = 0; timer < numberInstrumentationTimers; timer++)
+	{
+		nanoseconds[timer] = 0;
+		calls[timer] = 0;
+	}
+	for (int counter = 0; counter < numberInstrumentationCounters; counter++)
+	{
+		counts[counter] = 0;
+	}
+	std::lock_guard<std::mutex> lock(getRegistryMutex());
+	getRegistry().push_back(this);
+}
+
+ThreadInstrumentation::~ThreadInstrumentation()
+{
+	std::lock_guard<std::mutex> lock(getRegistryMutex());
+	InstrumentationTotals &retiredTotals = getRetiredTotals();
+	for (int timer = 0; timer < numberInstrumentationTimers; timer++)
+	{
+		retiredTotals.nanoseconds[timer] += nanoseconds[timer];
+		retiredTotals.calls[timer] += calls[timer];
+	}
+	for (int counter = 0; counter < numberInstrumentationCounters; counter++)
+	{
+		retiredTotals.counts[counter] += counts[counter];
+	}
+	std::vector<ThreadInstrumentation*> &registry = getRegistry();
+	registry.erase(std::find(registry.begin(), registry.end(), this));
+}
+
+static ThreadInstrumentation &getThreadInstrumentation()
+{
+	static thread_local ThreadInstrumentation threadInstrumentation;
+	return threadInstrumentation;
+}
+
+void addInstrumentationTime(InstrumentationTimer timer, long long nanoseconds)
+{
+	ThreadInstrumentation &threadInstrumentation = getThreadInstrumentation();
+	add(threadInstrumentation.nanoseconds[timer], nanoseconds);
+	add(threadInstrumentation.calls[timer], 1);
+}
+
+void addInstrumentationCount(InstrumentationCounter counter, long long count)
+{
+	add(getThreadInstrumentation().counts[counter], count);
+}
+
+/*
+The global allocation functions are replaced so every heap allocation is counted, including
+those made inside the standard library
+*/
+void *operator new(std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void *memory = std::malloc(size == 0 ? 1 : size);
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+#endif
+
+/*
+The totals over every thread so far, which are all 0 when instrumentation isn't built. Threads
+may be adding to their counters while they're read, so read them between generations for
+totals which add up
+*/
+InstrumentationTotals getInstrumentationTotals()
+{
+	InstrumentationTotals totals = {};
+#if INSTRUMENTATION
+	std::lock_guard<std::mutex> lock(getRegistryMutex());
+	totals = getRetiredTotals();
+	for (const ThreadInstrumentation *threadInstrumentation : getRegistry())
+	{
+		for (int timer = 0; timer < numberInstrumentationTimers; timer++)
+		{
+			totals.nanoseconds[timer] += threadInstrumentation->nanoseconds[timer].load(std::memory_order_relaxed);
+			totals.calls[timer] += threadInstrumentation->calls[timer].load(std::memory_order_relaxed);
+		}
+		for (int counter = 0; counter < numberInstrumentationCounters; counter++)
+		{
+			totals.counts[counter] += threadInstrumentation->counts[counter].load(std::memory_order_relaxed);
+		}
+	}
+	totals.counts[Allocations] += allocationCount.load(std::memory_order_relaxed);
+#endif
+	return totals;
+}
+
+const char *getInstrumentationTimerName(InstrumentationTimer timer)
+{
+	switch (timer)
+	{
+	case SenseTimer:
+		return "sense";
+	case InferenceTimer:
+		return "inference";
+	case CollisionTimer:
+		return "collision";
+	case CheckPointTimer:
+		return "checkPoint";
+	case SelectionTimer:
+		return "selection";
+	case BreedingTimer:
+		return "breeding";
+	}
+	return "unknown";
+}
+
+const char *getInstrumentationCounterName(InstrumentationCounter counter)
+{
+	switch (counter)
+	{
+	case RaySegmentTests:
+		return "raySegmentTests";
+	case Allocations:
+		return "allocations";
+	case AgentTicks:
+		return "agentTicks";
+	}
+	return "unknown";
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+#include <chrono>
+
+/*
+Timers and counters for the hot paths of a run, for finding where its time goes. They are only
+built when INSTRUMENTATION is defined as 1 (by passing -DINSTRUMENTATION=1 to the compiler), and
+otherwise INSTRUMENT_SCOPE and INSTRUMENT_COUNT expand to nothing so release builds carry no
+trace of them. Each thread adds to counters of its own, so instrumenting doesn't make threads
+contend, and the totals over every thread are read between generations
+*/
+#ifndef INSTRUMENTATION
+#define INSTRUMENTATION 0
+#endif
+
+enum InstrumentationTimer
+{
+	SenseTimer,
+	InferenceTimer,
+	CollisionTimer,
+	CheckPointTimer,
+	SelectionTimer,
+	BreedingTimer
+};
+
+const int numberInstrumentationTimers = BreedingTimer + 1;
+
+enum InstrumentationCounter
+{
+	RaySegmentTests,
+	Allocations,
+	AgentTicks
+};
+
+const int numberInstrumentationCounters = AgentTicks + 1;
+
+// The time spent in and number of calls to each timer and the count of each counter so far
+struct InstrumentationTotals
+{
+	long long nanoseconds[numberInstrumentationTimers];
+	long long calls[numberInstrumentationTimers];
+	long long counts[numberInstrumentationCounters];
+};
+
+InstrumentationTotals getInstrumentationTotals();
+
+const char *getInstrumentationTimerName(InstrumentationTimer);
+
+const char *getInstrumentationCounterName(InstrumentationCounter);
+
+#if INSTRUMENTATION
+void addInstrumentationTime(InstrumentationTimer, long long);
+
+void addInstrumentationCount(InstrumentationCounter, long long);
+
+// Adds the time from its construction to its destruction to a timer
+class ScopedTimer
+{
+public:
+	ScopedTimer(InstrumentationTimer timer)
+		: timer(timer), startTime(std::chrono::steady_clock::now())
+	{
+	}
+
+	~ScopedTimer()
+	{
+		addInstrumentationTime(timer, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer &operator=(const ScopedTimer&) = delete;
+
+private:
+	InstrumentationTimer timer;
+	std::chrono::steady_clock::time_point startTime;
+};
+
+#define INSTRUMENT_CONCATENATE(first, second) first##second
+#define INSTRUMENT_NAME(line) INSTRUMENT_CONCATENATE(scopedTimer, line)
+#define INSTRUMENT_SCOPE(timer) ScopedTimer INSTRUMENT_NAME(__LINE__)(timer)
+#define INSTRUMENT_COUNT(counter, count) addInstrumentationCount(counter, count)
+#else
+#define INSTRUMENT_SCOPE(timer)
+#define INSTRUMENT_COUNT(counter, count)
+#endif
\ No newline at end of file
@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <limits>
+#include "CpuFeatures.h"
+#include "Instrumentation.h"
+#include "Intersection.h"
+#if SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+SegmentArrays::SegmentArrays()
+	: builtStartX(padding, 0), builtStartY(padding, 0), builtDeltaX(padding, 0), builtDeltaY(padding, 0)
+{
+	bind();
+}
+
+/*
+A view of count segments stored elsewhere, each array of which must be padded with another
+padding values. The owner keeps the arrays alive for as long as the view is used
+*/
+SegmentArrays::SegmentArrays(std::shared_ptr<const void> owner, const float *startX, const float *startY, const float *deltaX, const float *deltaY, int count)
+	: numberSegments(count), owner(owner), startX(startX), startY(startY), deltaX(deltaX), deltaY(deltaY)
+{
+}
+
+// Adds a segment before the padding of arrays being built
+void SegmentArrays::append(Segment segment)
+{
+	PreparedSegment prepared = prepareSegment(segment);
+	builtStartX[numberSegments] = prepared.start.x;
+	builtStartY[numberSegments] = prepared.start.y;
+	builtDeltaX[numberSegments] = prepared.delta.x;
+	builtDeltaY[numberSegments] = prepared.delta.y;
+	numberSegments++;
+	builtStartX.resize(numberSegments + padding, 0);
+	builtStartY.resize(numberSegments + padding, 0);
+	builtDeltaX.resize(numberSegments + padding, 0);
+	builtDeltaY.resize(numberSegments + padding, 0);
+	bind();
+}
+
+// Points the arrays at the ones being built
+void SegmentArrays::bind()
+{
+	startX = builtStartX.data();
+	startY = builtStartY.data();
+	deltaX = builtDeltaX.data();
+	deltaY = builtDeltaY.data();
+}
+
+int SegmentArrays::size() const
+{
+	return numberSegments;
+}
+
+PreparedSegment SegmentArrays::get(int index) const
+{
+	return { { startX[index], startY[index] }, { deltaX[index], deltaY[index] } };
+}
+
+// Getter
+const float *SegmentArrays::getStartX() const
+{
+	return startX;
+}
+
+// Getter
+const float *SegmentArrays::getStartY() const
+{
+	return startY;
+}
+
+// Getter
+const float *SegmentArrays::getDeltaX() const
+{
+	return deltaX;
+}
+
+// Getter
+const float *SegmentArrays::getDeltaY() const
+{
+	return deltaY;
+}
+
+/*
+The scalar kernels test one segment at a time with checkIntersection. The SIMD kernels work
+out lambda and mu for a whole vector of segments with the same operations in the same order,
+so with contraction into FMA instructions disabled they give bit for bit the same results
+*/
+static float nearestScalar(const SegmentArrays &segments, int begin, int end, Vector2 rayStart, Vector2 rayEnd, float nearest, float maxDistance)
+{
+	for (int i = begin; i < end; i++)
+	{
+		intersectionPoint intersection = checkIntersection(segments.get(i), rayStart, rayEnd);
+		float lambda = intersection.lambda;
+		float mu = intersection.mu;
+		// Handles parallel lines 
+		if (lambda == 0 && mu == 0)
+		{
+			continue;
+		}
+		if (0 < lambda && lambda < 1 && mu > 0 && mu < nearest && mu <= maxDistance)
+		{
+			nearest = mu;
+		}
+	}
+	return nearest;
+}
+
+static bool anyScalar(const SegmentArrays &segments, int begin, int end, Vector2 start, Vector2 finish)
+{
+	for (int i = begin; i < end; i++)
+	{
+		intersectionPoint intersection = checkIntersection(segments.get(i), start, finish);
+		float lambda = intersection.lambda;
+		float mu = intersection.mu;
+		if (lambda == 0 && mu == 0)
+		{
+			continue;
+		}
+		if (0 <= lambda && lambda <= 1 && 0 <= mu && mu <= 1)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+#if SIMD_KERNELS
+/*
+Works out lambda and mu between 8 segments starting at index i and the line from lineStart,
+whose start minus end is lineDelta. Lanes where the lines are parallel are left out of the
+returned mask, along with those at or past end
+*/
+TARGET_AVX2 static __m256 intersect256(const SegmentArrays &segments, int i, int end, __m256 lineStartX, __m256 lineStartY,
+	__m256 lineDeltaX, __m256 lineDeltaY, __m256 &lambda, __m256 &mu)
+{
+	__m256 startX = _mm256_loadu_ps(segments.getStartX() + i);
+	__m256 startY = _mm256_loadu_ps(segments.getStartY() + i);
+	__m256 deltaX = _mm256_loadu_ps(segments.getDeltaX() + i);
+	__m256 deltaY = _mm256_loadu_ps(segments.getDeltaY() + i);
+	__m256 denominator = _mm256_sub_ps(_mm256_mul_ps(deltaX, lineDeltaY), _mm256_mul_ps(deltaY, lineDeltaX));
+	__m256 offsetX = _mm256_sub_ps(startX, lineStartX);
+	__m256 offsetY = _mm256_sub_ps(startY, lineStartY);
+	lambda = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(offsetX, lineDeltaY), _mm256_mul_ps(offsetY, lineDeltaX)), denominator);
+	__m256 negatedMu = _mm256_sub_ps(_mm256_mul_ps(deltaX, offsetY), _mm256_mul_ps(deltaY, offsetX));
+	mu = _mm256_div_ps(_mm256_xor_ps(negatedMu, _mm256_set1_ps(-0.0f)), denominator);
+	__m256i inRange = _mm256_cmpgt_epi32(_mm256_set1_epi32(end - i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+	__m256 notParallel = _mm256_cmp_ps(denominator, _mm256_setzero_ps(), _CMP_NEQ_OQ);
+	return _mm256_and_ps(notParallel, _mm256_castsi256_ps(inRange));
+}
+
+TARGET_AVX2 static float horizontalMin256(__m256 values)
+{
+	__m128 lower = _mm_min_ps(_mm256_castps256_ps128(values), _mm256_extractf128_ps(values, 1));
+	lower = _mm_min_ps(lower, _mm_movehl_ps(lower, lower));
+	lower = _mm_min_ss(lower, _mm_shuffle_ps(lower, lower, 1));
+	return _mm_cvtss_f32(lower);
+}
+
+// Keeps the smallest qualifying mu in each lane and takes the minimum across lanes at the end
+TARGET_AVX2 static float nearestAvx2(const SegmentArrays &segments, int begin, int end, Vector2 rayStart, Vector2 rayEnd, float nearest, float maxDistance)
+{
+	__m256 lineStartX = _mm256_set1_ps(rayStart.x);
+	__m256 lineStartY = _mm256_set1_ps(rayStart.y);
+	__m256 lineDeltaX = _mm256_set1_ps(rayStart.x - rayEnd.x);
+	__m256 lineDeltaY = _mm256_set1_ps(rayStart.y - rayEnd.y);
+	__m256 zero = _mm256_setzero_ps();
+	__m256 one = _mm256_set1_ps(1);
+	__m256 limit = _mm256_set1_ps(maxDistance);
+	__m256 infinity = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+	__m256 lanesNearest = infinity;
+	for (int i = begin; i < end; i += 8)
+	{
+		__m256 lambda, mu;
+		__m256 mask = intersect256(segments, i, end, lineStartX, lineStartY, lineDeltaX, lineDeltaY, lambda, mu);
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(lambda, zero, _CMP_GT_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(lambda, one, _CMP_LT_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(mu, zero, _CMP_GT_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(mu, limit, _CMP_LE_OQ));
+		lanesNearest = _mm256_min_ps(lanesNearest, _mm256_blendv_ps(infinity, mu, mask));
+	}
+	return std::min(nearest, horizontalMin256(lanesNearest));
+}
+
+TARGET_AVX2 static bool anyAvx2(const SegmentArrays &segments, int begin, int end, Vector2 start, Vector2 finish)
+{
+	__m256 lineStartX = _mm256_set1_ps(start.x);
+	__m256 lineStartY = _mm256_set1_ps(start.y);
+	__m256 lineDeltaX = _mm256_set1_ps(start.x - finish.x);
+	__m256 lineDeltaY = _mm256_set1_ps(start.y - finish.y);
+	__m256 zero = _mm256_setzero_ps();
+	__m256 one = _mm256_set1_ps(1);
+	for (int i = begin; i < end; i += 8)
+	{
+		__m256 lambda, mu;
+		__m256 mask = intersect256(segments, i, end, lineStartX, lineStartY, lineDeltaX, lineDeltaY, lambda, mu);
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(lambda, zero, _CMP_GE_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(lambda, one, _CMP_LE_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(mu, zero, _CMP_GE_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(mu, one, _CMP_LE_OQ));
+		// Crossing exactly at both starts is treated as parallel, as checkIntersection reports it the same way
+		__m256 bothZero = _mm256_and_ps(_mm256_cmp_ps(lambda, zero, _CMP_EQ_OQ), _mm256_cmp_ps(mu, zero, _CMP_EQ_OQ));
+		if (_mm256_movemask_ps(_mm256_andnot_ps(bothZero, mask)))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// The same as intersect256 for 16 segments, with the mask held in a mask register
+TARGET_AVX512 static __mmask16 intersect512(const SegmentArrays &segments, int i, int end, __m512 lineStartX, __m512 lineStartY,
+	__m512 lineDeltaX, __m512 lineDeltaY, __m512 &lambda, __m512 &mu)
+{
+	__mmask16 inRange = end - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1 << (end - i)) - 1);
+	__m512 startX = _mm512_loadu_ps(segments.getStartX() + i);
+	__m512 startY = _mm512_loadu_ps(segments.getStartY() + i);
+	__m512 deltaX = _mm512_loadu_ps(segments.getDeltaX() + i);
+	__m512 deltaY = _mm512_loadu_ps(segments.getDeltaY() + i);
+	__m512 denominator = _mm512_sub_ps(_mm512_mul_ps(deltaX, lineDeltaY), _mm512_mul_ps(deltaY, lineDeltaX));
+	__m512 offsetX = _mm512_sub_ps(startX, lineStartX);
+	__m512 offsetY = _mm512_sub_ps(startY, lineStartY);
+	lambda = _mm512_div_ps(_mm512_sub_ps(_mm512_mul_ps(offsetX, lineDeltaY), _mm512_mul_ps(offsetY, lineDeltaX)), denominator);
+	__m512 negatedMu = _mm512_sub_ps(_mm512_mul_ps(deltaX, offsetY), _mm512_mul_ps(deltaY, offsetX));
+	__m512i signBit = _mm512_set1_epi32((int)0x80000000);
+	mu = _mm512_div_ps(_mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(negatedMu), signBit)), denominator);
+	return _mm512_mask_cmp_ps_mask(inRange, denominator, _mm512_setzero_ps(), _CMP_NEQ_OQ);
+}
+
+TARGET_AVX512 static float nearestAvx512(const SegmentArrays &segments, int begin, int end, Vector2 rayStart, Vector2 rayEnd, float nearest, float maxDistance)
+{
+	__m512 lineStartX = _mm512_set1_ps(rayStart.x);
+	__m512 lineStartY = _mm512_set1_ps(rayStart.y);
+	__m512 lineDeltaX = _mm512_set1_ps(rayStart.x - rayEnd.x);
+	__m512 lineDeltaY = _mm512_set1_ps(rayStart.y - rayEnd.y);
+	__m512 zero = _mm512_setzero_ps();
+	__m512 one = _mm512_set1_ps(1);
+	__m512 limit = _mm512_set1_ps(maxDistance);
+	__m512 lanesNearest = _mm512_set1_ps(std::numeric_limits<float>::infinity());
+	for (int i = begin; i < end; i += 16)
+	{
+		__m512 lambda, mu;
+		__mmask16 mask = intersect512(segments, i, end, lineStartX, lineStartY, lineDeltaX, lineDeltaY, lambda, mu);
+		mask = _mm512_mask_cmp_ps_mask(mask, lambda, zero, _CMP_GT_OQ);
+		mask = _mm512_mask_cmp_ps_mask(mask, lambda, one, _CMP_LT_OQ);
+		mask = _mm512_mask_cmp_ps_mask(mask, mu, zero, _CMP_GT_OQ);
+		mask = _mm512_mask_cmp_ps_mask(mask, mu, limit, _CMP_LE_OQ);
+		lanesNearest = _mm512_mask_min_ps(lanesNearest, mask, lanesNearest, mu);
+	}
+	return std::min(nearest, _mm512_reduce_min_ps(lanesNearest));
+}
+
+TARGET_AVX512 static bool anyAvx512(const SegmentArrays &segments, int begin, int end, Vector2 start, Vector2 finish)
+{
+	__m512 lineStartX = _mm512_set1_ps(start.x);
+	__m512 lineStartY = _mm512_set1_ps(start.y);
+	__m512 lineDeltaX = _mm512_set1_ps(start.x - finish.x);
+	__m512 lineDeltaY = _mm512_set1_ps(start.y - finish.y);
+	__m512 zero = _mm512_setzero_ps();
+	__m512 one = _mm512_set1_ps(1);
+	for (int i = begin; i < end; i += 16)
+	{
+		__m512 lambda, mu;
+		__mmask16 mask = intersect512(segments, i, end, lineStartX, lineStartY, lineDeltaX, lineDeltaY, lambda, mu);
+		mask = _mm512_mask_cmp_ps_mask(mask, lambda, zero, _CMP_GE_OQ);
+		mask = _mm512_mask_cmp_ps_mask(mask, lambda, one, _CMP_LE_OQ);
+		mask = _mm512_mask_cmp_ps_mask(mask, mu, zero, _CMP_GE_OQ);
+		mask = _mm512_mask_cmp_ps_mask(mask, mu, one, _CMP_LE_OQ);
+		__mmask16 bothZero = _mm512_cmp_ps_mask(lambda, zero, _CMP_EQ_OQ) & _mm512_cmp_ps_mask(mu, zero, _CMP_EQ_OQ);
+		if (mask & ~bothZero)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+#endif
+
+/*
+The smaller of nearest and the nearest intersection with segments [begin, end) of the ray
+from rayStart to rayEnd, measured as the proportion mu along the ray. Only intersections
+strictly inside a segment and with 0 < mu <= maxDistance count
+*/
+float nearestIntersection(IntersectionKernel kernel, const SegmentArrays &segments, int begin, int end, Vector2 rayStart, Vector2 rayEnd, float nearest, float maxDistance)
+{
+	INSTRUMENT_COUNT(RaySegmentTests, end - begin);
+	switch (kernel)
+	{
+#if SIMD_KERNELS
+	case Avx2Intersection:
+		return nearestAvx2(segments, begin, end, rayStart, rayEnd, nearest, maxDistance);
+	case Avx512Intersection:
+		return nearestAvx512(segments, begin, end, rayStart, rayEnd, nearest, maxDistance);
+#endif
+	default:
+		return nearestScalar(segments, begin, end, rayStart, rayEnd, nearest, maxDistance);
+	}
+}
+
+// Whether the segment from start to finish intersects any of segments [begin, end), including at their ends
+bool anyIntersection(IntersectionKernel kernel, const SegmentArrays &segments, int begin, int end, Vector2 start, Vector2 finish)
+{
+	// Counts every segment in the range, though the test stops at the first hit
+	INSTRUMENT_COUNT(RaySegmentTests, end - begin);
+	switch (kernel)
+	{
+#if SIMD_KERNELS
+	case Avx2Intersection:
+		return anyAvx2(segments, begin, end, start, finish);
+	case Avx512Intersection:
+		return anyAvx512(segments, begin, end, start, finish);
+#endif
+	default:
+		return anyScalar(segments, begin, end, start, finish);
+	}
+}
+
+// The fastest kernel the CPU supports
+IntersectionKernel bestIntersectionKernel()
+{
+	if (isIntersectionKernelSupported(Avx512Intersection))
+	{
+		return Avx512Intersection;
+	}
+	if (isIntersectionKernelSupported(Avx2Intersection))
+	{
+		return Avx2Intersection;
+	}
+	return ScalarIntersection;
+}
+
+bool isIntersectionKernelSupported(IntersectionKernel kernel)
+{
+	switch (kernel)
+	{
+	case Avx2Intersection:
+		return SIMD_KERNELS && cpuSupportsAvx2();
+	case Avx512Intersection:
+		return SIMD_KERNELS && cpuSupportsAvx512() && cpuSupportsAvx2();
+	default:
+		return true;
+	}
+}
+
+const char *getIntersectionKernelName(IntersectionKernel kernel)
+{
+	switch (kernel)
+	{
+	case ScalarIntersection:
+		return "scalar";
+	case Avx2Intersection:
+		return "avx2";
+	case Avx512Intersection:
+		return "avx512";
+	}
+	return "unknown";
+}
+
+// Looks up a kernel by the name getIntersectionKernelName gives it
+bool parseIntersectionKernel(std::string name, IntersectionKernel &kernel)
+{
+	for (IntersectionKernel candidate : { ScalarIntersection, Avx2Intersection, Avx512Intersection })
+	{
+		if (name == getIntersectionKernelName(candidate))
+		{
+			kernel = candidate;
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "Geometry.h"
+
+enum IntersectionKernel
+{
+	ScalarIntersection,
+	Avx2Intersection,
+	Avx512Intersection
+};
+
+/*
+Prepared segments stored as a structure of arrays so the SIMD kernels can load the same
+coordinate of 8 or 16 segments at once. The arrays are padded past the last segment so a
+kernel can always load a whole vector, with the lanes past the end of a range masked off.
+The arrays are either built up by appending segments or are a view of arrays stored
+elsewhere (such as in a mapped track file) which are kept alive by a shared owner. Segment
+arrays can be moved but not copied, as the arrays they build are pointed into
+*/
+class SegmentArrays
+{
+public:
+	static const int padding = 16;
+
+	SegmentArrays();
+	SegmentArrays(std::shared_ptr<const void>, const float*, const float*, const float*, const float*, int);
+	SegmentArrays(SegmentArrays&&) = default;
+	SegmentArrays &operator=(SegmentArrays&&) = default;
+
+	void append(Segment);
+
+	int size() const;
+
+	PreparedSegment get(int) const;
+
+	const float *getStartX() const;
+
+	const float *getStartY() const;
+
+	const float *getDeltaX() const;
+
+	const float *getDeltaY() const;
+
+private:
+	void bind();
+
+	int numberSegments = 0;
+	std::vector<float> builtStartX;
+	std::vector<float> builtStartY;
+	std::vector<float> builtDeltaX;
+	std::vector<float> builtDeltaY;
+	std::shared_ptr<const void> owner;
+	const float *startX = nullptr;
+	const float *startY = nullptr;
+	const float *deltaX = nullptr;
+	const float *deltaY = nullptr;
+};
+
+float nearestIntersection(IntersectionKernel, const SegmentArrays&, int, int, Vector2, Vector2, float, float);
+
+bool anyIntersection(IntersectionKernel, const SegmentArrays&, int, int, Vector2, Vector2);
+
+IntersectionKernel bestIntersectionKernel();
+
+bool isIntersectionKernelSupported(IntersectionKernel);
+
+const char *getIntersectionKernelName(IntersectionKernel);
+
+bool parseIntersectionKernel(std::string, IntersectionKernel&);
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "IslandModel.h"
+
+/*
+Creates the islands on the track, each the size of the map's population. Their random
+streams are split in turn from the given seed's so a run can be repeated exactly, whatever
+the number of threads (0 uses every hardware thread)
+*/
+IslandModel::IslandModel(std::shared_ptr<const Track> track, int numberIslands, uint64_t seed, int numberThreads)
+	: threadPool(numberThreads)
+{
+	Random streams(seed);
+	for (int island = 0; island < numberIslands; island++)
+	{
+		islands.push_back(std::unique_ptr<Simulation>(new Simulation(track, 1, streams.split())));
+	}
+}
+
+/*
+Sets how many generations pass between migrations (0 never migrates), how many agents each
+island sends to each of its neighbours and which islands are neighbours
+*/
+void IslandModel::setMigration(int interval, int migrants, MigrationTopology migrationTopology)
+{
+	migrationInterval = interval;
+	numberMigrants = migrants;
+	topology = migrationTopology;
+}
+
+/*
+Runs a generation on every island in parallel, migrating between the islands once every
+agent has failed and before the next generations are bred
+*/
+std::vector<GenerationStatistics> IslandModel::runGeneration()
+{
+	int numberIslands = islands.size();
+	threadPool.parallelFor(numberIslands, 1, [this](int begin, int end, int)
+	{
+		for (int island = begin; island < end; island++)
+		{
+			while (!islands[island]->isGenerationComplete())
+			{
+				islands[island]->step();
+			}
+		}
+	});
+	if (migrationInterval > 0 && currentGeneration % migrationInterval == 0)
+	{
+		migrate();
+	}
+	currentGeneration++;
+	std::vector<GenerationStatistics> statistics(numberIslands);
+	threadPool.parallelFor(numberIslands, 1, [this, &statistics](int begin, int end, int)
+	{
+		for (int island = begin; island < end; island++)
+		{
+			statistics[island] = islands[island]->nextGeneration();
+		}
+	});
+	return statistics;
+}
+
+/*
+Every island's migrants are chosen before any arrive so the result doesn't depend on the
+order the islands are visited in
+*/
+void IslandModel::migrate()
+{
+	int numberIslands = islands.size();
+	std::vector<std::vector<float>> genomes(numberIslands);
+	std::vector<std::vector<float>> fitnesses(numberIslands);
+	for (int island = 0; island < numberIslands; island++)
+	{
+		islands[island]->selectMigrants(numberMigrants, genomes[island], fitnesses[island]);
+	}
+	for (int island = 0; island < numberIslands; island++)
+	{
+		std::vector<float> arrivingGenomes;
+		std::vector<float> arrivingFitnesses;
+		for (int source = 0; source < numberIslands; source++)
+		{
+			bool isNeighbour = topology == RingTopology ? (source + 1) % numberIslands == island : source != island;
+			if (isNeighbour && source != island)
+			{
+				arrivingGenomes.insert(arrivingGenomes.end(), genomes[source].begin(), genomes[source].end());
+				arrivingFitnesses.insert(arrivingFitnesses.end(), fitnesses[source].begin(), fitnesses[source].end());
+			}
+		}
+		islands[island]->acceptMigrants(arrivingGenomes, arrivingFitnesses);
+	}
+}
+
+// Getter
+int IslandModel::getNumberIslands()
+{
+	return islands.size();
+}
+
+// Getter
+Simulation &IslandModel::getIsland(int island)
+{
+	return *islands[island];
+}
+
+// Snapshots every island, writing them to the given path in the background
+void IslandModel::saveSnapshot(SnapshotWriter &writer, std::string path)
+{
+	const Population &population = islands[0]->getPopulation();
+	writer.begin(islands.size(), population.networkArchitecture, population.numberWeights, population.genomeStride);
+	for (std::unique_ptr<Simulation> &island : islands)
+	{
+		island->saveState(writer);
+	}
+	writer.save(path);
+}
+
+/*
+Carries on from a snapshot of the same number of islands. The migration settings aren't
+saved, so a run must be resumed with the ones it was started with
+*/
+bool IslandModel::restoreSnapshot(SnapshotReader &reader)
+{
+	if (reader.getHeader().numberSimulations != islands.size())
+	{
+		return reader.fail("The snapshot holds " + std::to_string(reader.getHeader().numberSimulations) + " islands, not "
+			+ std::to_string(islands.size()));
+	}
+	for (std::unique_ptr<Simulation> &island : islands)
+	{
+		if (!island->restoreState(reader))
+		{
+			return false;
+		}
+	}
+	currentGeneration = islands[0]->getGeneration();
+	return true;
+}
+
+const char *getMigrationTopologyName(MigrationTopology topology)
+{
+	switch (topology)
+	{
+	case RingTopology:
+		return "ring";
+	case FullyConnectedTopology:
+		return "full";
+	}
+	return "unknown";
+}
+
+// Looks up a topology by the name getMigrationTopologyName gives it
+bool parseMigrationTopology(std::string name, MigrationTopology &topology)
+{
+	for (MigrationTopology candidate : { RingTopology, FullyConnectedTopology })
+	{
+		if (name == getMigrationTopologyName(candidate))
+		{
+			topology = candidate;
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
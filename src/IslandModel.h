@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Simulation.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
+#include "Track.h"
+
+enum MigrationTopology
+{
+	RingTopology,
+	FullyConnectedTopology
+};
+
+/*
+Evolves several populations (islands) independently, each with its own random stream, on
+separate threads. Every few generations the fittest agents of each island migrate to its
+neighbours (the next island round a ring, or every other island) where they replace the
+least fit agents before the next generation is bred. Islands drift towards different
+solutions between migrations, which keeps the diversity of the whole population up, and as
+they never share mutable state they scale with the number of cores
+*/
+class IslandModel
+{
+public:
+	IslandModel(std::shared_ptr<const Track>, int, uint64_t, int = 0);
+
+	void setMigration(int, int, MigrationTopology);
+
+	std::vector<GenerationStatistics> runGeneration();
+
+	int getNumberIslands();
+
+	Simulation &getIsland(int);
+
+	void saveSnapshot(SnapshotWriter&, std::string);
+
+	bool restoreSnapshot(SnapshotReader&);
+
+private:
+	void migrate();
+
+	std::vector<std::unique_ptr<Simulation>> islands;
+	ThreadPool threadPool;
+	int migrationInterval = 10;
+	int numberMigrants = 2;
+	MigrationTopology topology = RingTopology;
+	int currentGeneration = 1;
+};
+
+const char *getMigrationTopologyName(MigrationTopology);
+
+bool parseMigrationTopology(std::string, MigrationTopology&);
\ No newline at end of file
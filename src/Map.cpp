@@ -0,0 +1,200 @@
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include "Map.h"
+
+/*
+Reads the numbers of a map file in turn, counting the lines it passes so a problem can be
+reported with where it is
+*/
+class MapParser
+{
+public:
+	MapParser(std::string path, const std::string &contents)
+		: path(path), position(contents.c_str()), end(contents.c_str() + contents.size())
+	{
+	}
+
+	// Reads a finite number
+	bool readFloat(float &value, const char *what)
+	{
+		if (!skipSpace(what))
+		{
+			return false;
+		}
+		char *numberEnd;
+		errno = 0;
+		value = std::strtof(position, &numberEnd);
+		if (!isNumberEnd(numberEnd) || errno == ERANGE || !std::isfinite(value))
+		{
+			return fail(describe(what) + " isn't a finite number");
+		}
+		position = numberEnd;
+		return true;
+	}
+
+	// Reads a whole number which is at least minimum
+	bool readInt(int &value, const char *what, int minimum = INT_MIN)
+	{
+		if (!skipSpace(what))
+		{
+			return false;
+		}
+		char *numberEnd;
+		errno = 0;
+		long number = std::strtol(position, &numberEnd, 10);
+		if (!isNumberEnd(numberEnd) || errno == ERANGE || number < minimum || number > INT_MAX)
+		{
+			return fail(describe(what) + " isn't a whole number" + (minimum > INT_MIN ? " of at least " + std::to_string(minimum) : ""));
+		}
+		value = number;
+		position = numberEnd;
+		return true;
+	}
+
+	// Checks there's nothing but white space left
+	bool finish()
+	{
+		skipSpace("");
+		return position == end || fail("there's more after the last check point");
+	}
+
+	bool fail(std::string reason)
+	{
+		error = path + ":" + std::to_string(line) + ": " + reason;
+		return false;
+	}
+
+	std::string error;
+	// The map element being read, if any, which is only put into words when there's a problem
+	int mapElement = -1;
+
+private:
+	// Moves on to the next number, failing if the file ends first
+	bool skipSpace(const char *what)
+	{
+		while (position != end && std::isspace((unsigned char)*position))
+		{
+			line += *position == '\n';
+			position++;
+		}
+		return position != end || fail("the file ends before " + describe(what));
+	}
+
+	std::string describe(const char *what) const
+	{
+		return what + (mapElement >= 0 ? " of map element " + std::to_string(mapElement + 1) : "");
+	}
+
+	bool isNumberEnd(const char *numberEnd) const
+	{
+		return numberEnd != position && (numberEnd == end || std::isspace((unsigned char)*numberEnd));
+	}
+
+	std::string path;
+	const char *position;
+	const char *end;
+	int line = 1;
+};
+
+/*
+Parses data from a map file (format explained in README.md), checking that every number is
+there and makes sense. Returns false with the file, line and problem in error if not
+*/
+bool loadMap(std::string path, Map &map, std::string &error)
+{
+	std::ifstream mapFile(path, std::ios::binary);
+	if (!mapFile)
+	{
+		error = "Couldn't open " + path;
+		return false;
+	}
+	std::string contents((std::istreambuf_iterator<char>(mapFile)), std::istreambuf_iterator<char>());
+	MapParser parser(path, contents);
+	map = Map();
+	int numberMapElements;
+	int numberCheckPoints;
+	bool parsed = parser.readFloat(map.startingPosition.x, "the starting x-coordinate")
+		&& parser.readFloat(map.startingPosition.y, "the starting y-coordinate")
+		&& parser.readInt(map.startingAngle, "the starting angle")
+		&& parser.readInt(map.numberAgents, "the number of agents", minNumberAgents)
+		&& parser.readInt(numberMapElements, "the number of map elements", 0);
+	for (int currentMapElement = 0; parsed && currentMapElement < numberMapElements; currentMapElement++)
+	{
+		parser.mapElement = currentMapElement;
+		int numberVertices;
+		parsed = parser.readInt(numberVertices, "the number of vertices", 0);
+		std::vector<Vector2> newMapElement;
+		for (int currentVertex = 0; parsed && currentVertex < numberVertices; currentVertex++)
+		{
+			Vector2 coordinates;
+			parsed = parser.readFloat(coordinates.x, "an x-coordinate")
+				&& parser.readFloat(coordinates.y, "a y-coordinate");
+			newMapElement.push_back(coordinates);
+		}
+		map.mapElements.push_back(std::move(newMapElement));
+	}
+	parser.mapElement = -1;
+	parsed = parsed && parser.readInt(numberCheckPoints, "the number of check point vertices", 0);
+	if (parsed && numberCheckPoints % 2 != 0)
+	{
+		parsed = parser.fail("the number of check point vertices is odd but they come in pairs");
+	}
+	for (int i = 0; parsed && i < numberCheckPoints; i++)
+	{
+		Vector2 coordinates;
+		parsed = parser.readFloat(coordinates.x, "a check point x-coordinate")
+			&& parser.readFloat(coordinates.y, "a check point y-coordinate");
+		map.checkPoints.push_back(coordinates);
+	}
+	if (!parsed || !parser.finish())
+	{
+		error = parser.error;
+		return false;
+	}
+	return true;
+}
+
+// Writes a map in the format loadMap reads, with each map element and check point on a line
+bool saveMap(std::string path, const Map &map)
+{
+	std::ofstream mapFile(path, std::ios::trunc);
+	mapFile.precision(std::numeric_limits<float>::max_digits10);
+	mapFile << map.startingPosition.x << ' ' << map.startingPosition.y << ' ' << map.startingAngle << '\n'
+		<< map.numberAgents << "\n\n" << map.mapElements.size() << '\n';
+	for (const std::vector<Vector2> &mapElement : map.mapElements)
+	{
+		mapFile << mapElement.size() << '\n';
+		for (int i = 0; i < (int)mapElement.size(); i++)
+		{
+			mapFile << (i > 0 ? " " : "") << mapElement[i].x << ' ' << mapElement[i].y;
+		}
+		mapFile << '\n';
+	}
+	mapFile << '\n' << map.checkPoints.size() << '\n';
+	for (int i = 0; i < (int)map.checkPoints.size(); i++)
+	{
+		mapFile << map.checkPoints[i].x << ' ' << map.checkPoints[i].y << (i % 2 == 1 ? '\n' : ' ');
+	}
+	mapFile.flush();
+	return mapFile.good();
+}
+
+// Flattens the line strips of the map elements into the individual wall segments
+std::vector<Segment> getWallSegments(const Map &map)
+{
+	std::vector<Segment> segments;
+	for (const std::vector<Vector2> &mapElement : map.mapElements)
+	{
+		for (int i = 0; i < (int)mapElement.size() - 1; i++)
+		{
+			segments.push_back({ mapElement[i], mapElement[i + 1] });
+		}
+	}
+	return segments;
+}
\ No newline at end of file
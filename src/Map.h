@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Geometry.h"
+
+/*
+Contents of a map file (format explained in README.md). Each map element is a line
+strip of wall vertices and the check points are stored as consecutive pairs of vertices
+*/
+struct Map
+{
+	Vector2 startingPosition;
+	int startingAngle;
+	int numberAgents;
+	std::vector<std::vector<Vector2>> mapElements;
+	std::vector<Vector2> checkPoints;
+};
+
+// The smallest population a generation can be bred from, which is one elite agent and a couple of parents
+const int minNumberAgents = 10;
+
+bool loadMap(std::string, Map&, std::string&);
+
+bool saveMap(std::string, const Map&);
+
+std::vector<Segment> getWallSegments(const Map&);
\ No newline at end of file
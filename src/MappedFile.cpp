@@ -0,0 +1,88 @@
+#include <fstream>
+#include <iterator>
+#include "MappedFile.h"
+#if MAPPED_FILES
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+// Maps (or reads) a file into memory, returning false if it can't be
+bool MappedFile::open(std::string path)
+{
+	close();
+#if MAPPED_FILES
+	int file = ::open(path.c_str(), O_RDONLY);
+	struct stat status;
+	if (file < 0 || fstat(file, &status) != 0)
+	{
+		if (file >= 0)
+		{
+			::close(file);
+		}
+		return false;
+	}
+	size = status.st_size;
+	if (size > 0)
+	{
+		void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapping != MAP_FAILED)
+		{
+			data = (const char*)mapping;
+			mapped = true;
+		}
+	}
+	::close(file);
+	if (size > 0 && !mapped)
+	{
+		size = 0;
+		return false;
+	}
+#else
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	data = contents.data();
+	size = contents.size();
+#endif
+	return true;
+}
+
+void MappedFile::close()
+{
+#if MAPPED_FILES
+	if (mapped)
+	{
+		munmap((void*)data, size);
+	}
+#endif
+	data = nullptr;
+	size = 0;
+	mapped = false;
+	contents.clear();
+}
+
+// Getter
+const char *MappedFile::getData() const
+{
+	return data;
+}
+
+// Getter
+size_t MappedFile::getSize() const
+{
+	return size;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Files are mapped into memory on POSIX systems and read in whole elsewhere
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILES 1
+#else
+#define MAPPED_FILES 0
+#endif
+
+/*
+The contents of a file, mapped read only into memory where possible so they can be used in
+place without being copied. The contents stay valid until the file is closed or another one
+is opened, so a mapped file is kept alive by whatever points into it
+*/
+class MappedFile
+{
+public:
+	MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile &operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	bool open(std::string);
+
+	void close();
+
+	const char *getData() const;
+
+	size_t getSize() const;
+
+private:
+	const char *data = nullptr;
+	size_t size = 0;
+	bool mapped = false;
+	std::vector<char> contents;
+};
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <stdexcept>
 #include "Matrix.h"
 
 Matrix::Matrix(char rows, char columns, std::vector<float> data)
@@ -51,11 +52,11 @@ Matrix Matrix::operator*(Matrix &otherMatrix)
 	{
 		for (char column = 0; column < otherColumns; column++)
 		{
-			for (char k = 0; k < thisColumns; k++)
+			for (int k = 0; k < thisColumns; k++)
 			{
 				currentRow[k] = matrixData[row * thisColumns + k];
 			}
-			for (char k = 0; k < otherRows; k++)
+			for (int k = 0; k < otherRows; k++)
 			{
 				currentColumn[k] = otherMatrix.matrixData[column + otherColumns * k];
 			}
@@ -63,8 +64,8 @@ Matrix Matrix::operator*(Matrix &otherMatrix)
 		}
 	}
 	// Free memory
-	delete currentRow;
-	delete currentColumn;
+	delete[] currentRow;
+	delete[] currentColumn;
 
 	return Matrix(thisRows, otherColumns, resultData);
 }
@@ -0,0 +1,364 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "CpuFeatures.h"
+#include "Matrix.h"
+#include "Network.h"
+#if SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+// Sigmoid activation function
+float sigmoid(float x)
+{
+	return 1 / (1 + exp(-x));
+}
+
+// The layer sizes of AgentNetwork
+std::vector<int> getAgentNetworkArchitecture()
+{
+	return std::vector<int>(AgentNetwork::layerSizes, AgentNetwork::layerSizes + AgentNetwork::numberLayers);
+}
+
+// Whether an architecture is the one AgentNetwork was compiled for
+bool isAgentNetwork(const std::vector<int> &networkArchitecture)
+{
+	return std::equal(networkArchitecture.begin(), networkArchitecture.end(), AgentNetwork::layerSizes,
+		AgentNetwork::layerSizes + AgentNetwork::numberLayers);
+}
+
+/*
+Evaluates one agent's network by multiplying its weight matrices and returns whether it
+decides to turn left. Inputs are read with the given stride so this can be pointed into a
+batch of inputs
+*/
+bool decideReference(const float *inputs, int inputStride, const float *genome, const std::vector<int> &networkArchitecture)
+{
+	std::vector<float> inputDistances;
+	for (int input = 0; input < networkArchitecture[0]; input++)
+	{
+		inputDistances.push_back(inputs[input * inputStride]);
+	}
+	// Feed the input through the neural network to obtain the output decision 
+	Matrix networkOutput(1, networkArchitecture[0], inputDistances);
+	for (int layer = 0; layer < (int)networkArchitecture.size() - 1; layer++)
+	{
+		char rows = networkArchitecture[layer];
+		char columns = networkArchitecture[layer + 1];
+		Matrix currentWeights(rows, columns, std::vector<float>(genome, genome + rows * columns));
+		genome += rows * columns;
+		networkOutput = networkOutput * currentWeights;
+		for (int node = 0; node < networkOutput.getDimensions().columns; node++)
+		{
+			float nodePreActivation = networkOutput(0, node);
+			float nodeValue = sigmoid(nodePreActivation);
+			networkOutput.setData(0, node, nodeValue);
+		}
+	}
+	return networkOutput(0, 0) >= networkOutput(0, 1);
+}
+
+/*
+Evaluates one agent's AgentNetwork using FixedMatrix objects, giving the same result as the
+reference evaluation without touching the heap
+*/
+bool decideFixed(const float *inputs, int inputStride, const float *genome)
+{
+	FixedMatrix<1, AgentNetwork::numberOutputs> networkOutput = AgentNetwork::forward(inputs, inputStride, genome, sigmoid);
+	return networkOutput(0, 0) >= networkOutput(0, 1);
+}
+
+// Runs the reference evaluation for each agent in a batch
+static void forwardReference(const float *inputs, int inputStride, const float *genomes, int genomeStride, const std::vector<int> &networkArchitecture, int count, char *decisions)
+{
+	for (int agent = 0; agent < count; agent++)
+	{
+		decisions[agent] = decideReference(inputs + agent, inputStride, genomes + (size_t)agent * genomeStride, networkArchitecture);
+	}
+}
+
+/*
+Evaluates a batch of agents with the same arithmetic, in the same order, as the reference
+kernel. AgentNetwork is evaluated with fixed size matrices and any other architecture uses
+stack arrays in place of Matrix objects
+*/
+static void forwardScalar(const float *inputs, int inputStride, const float *genomes, int genomeStride, const std::vector<int> &networkArchitecture, int count, char *decisions)
+{
+	if (isAgentNetwork(networkArchitecture))
+	{
+		for (int agent = 0; agent < count; agent++)
+		{
+			decisions[agent] = decideFixed(inputs + agent, inputStride, genomes + (size_t)agent * genomeStride);
+		}
+		return;
+	}
+	float activations[2][maxLayerWidth];
+	int numberLayers = networkArchitecture.size();
+	for (int agent = 0; agent < count; agent++)
+	{
+		const float *genome = genomes + (size_t)agent * genomeStride;
+		for (int input = 0; input < networkArchitecture[0]; input++)
+		{
+			activations[0][input] = inputs[input * inputStride + agent];
+		}
+		int current = 0;
+		for (int layer = 0; layer < numberLayers - 1; layer++)
+		{
+			int rows = networkArchitecture[layer];
+			int columns = networkArchitecture[layer + 1];
+			for (int column = 0; column < columns; column++)
+			{
+				float nodePreActivation = 0;
+				for (int row = 0; row < rows; row++)
+				{
+					nodePreActivation += activations[current][row] * genome[row * columns + column];
+				}
+				activations[1 - current][column] = sigmoid(nodePreActivation);
+			}
+			genome += rows * columns;
+			current = 1 - current;
+		}
+		decisions[agent] = activations[current][0] >= activations[current][1];
+	}
+}
+
+#if SIMD_KERNELS
+/*
+Vectorised double precision exp using the Cephes approximation: the input is split into
+n * ln(2) + r, exp(r) is evaluated with a rational function and then scaled by 2^n. The
+sigmoid is evaluated in double precision, as the scalar kernels' exp is, so that rounding
+the result to float almost always gives exactly the same value as the reference
+*/
+TARGET_AVX2 static __m256d exp256(__m256d x)
+{
+	x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-708.0)), _mm256_set1_pd(708.0));
+	__m256d n = _mm256_floor_pd(_mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634073599)), _mm256_set1_pd(0.5)));
+	x = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(6.93145751953125E-1)));
+	x = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(1.42860682030941723212E-6)));
+	__m256d xx = _mm256_mul_pd(x, x);
+	__m256d p = _mm256_set1_pd(1.26177193074810590878E-4);
+	p = _mm256_add_pd(_mm256_mul_pd(p, xx), _mm256_set1_pd(3.02994407707441961300E-2));
+	p = _mm256_add_pd(_mm256_mul_pd(p, xx), _mm256_set1_pd(9.99999999999999999910E-1));
+	p = _mm256_mul_pd(p, x);
+	__m256d q = _mm256_set1_pd(3.00198505138664455042E-6);
+	q = _mm256_add_pd(_mm256_mul_pd(q, xx), _mm256_set1_pd(2.52448340349684104192E-3));
+	q = _mm256_add_pd(_mm256_mul_pd(q, xx), _mm256_set1_pd(2.27265548208155028766E-1));
+	q = _mm256_add_pd(_mm256_mul_pd(q, xx), _mm256_set1_pd(2.00000000000000000009E0));
+	__m256d y = _mm256_add_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_set1_pd(2.0), _mm256_div_pd(p, _mm256_sub_pd(q, p))));
+	__m256i exponent = _mm256_slli_epi64(_mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n)), _mm256_set1_epi64x(1023)), 52);
+	return _mm256_mul_pd(y, _mm256_castsi256_pd(exponent));
+}
+
+TARGET_AVX2 static __m128 sigmoid128(__m128 x)
+{
+	__m256d one = _mm256_set1_pd(1.0);
+	__m256d negated = _mm256_sub_pd(_mm256_setzero_pd(), _mm256_cvtps_pd(x));
+	return _mm256_cvtpd_ps(_mm256_div_pd(one, _mm256_add_pd(one, exp256(negated))));
+}
+
+TARGET_AVX2 static __m256 sigmoid256(__m256 x)
+{
+	return _mm256_set_m128(sigmoid128(_mm256_extractf128_ps(x, 1)), sigmoid128(_mm256_castps256_ps128(x)));
+}
+
+/*
+Evaluates 8 agents at once with one agent per lane. Each weight is gathered from the 8
+genomes, which are a fixed stride apart, and the remainder of the batch falls back to the
+scalar kernel
+*/
+TARGET_AVX2 static void forwardAvx2(const float *inputs, int inputStride, const float *genomes, int genomeStride, const std::vector<int> &networkArchitecture, int count, char *decisions)
+{
+	__m256 activations[2][maxLayerWidth];
+	int numberLayers = networkArchitecture.size();
+	__m256i laneOffsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(genomeStride));
+	int agent = 0;
+	for (; agent + 8 <= count; agent += 8)
+	{
+		const float *genome = genomes + (size_t)agent * genomeStride;
+		for (int input = 0; input < networkArchitecture[0]; input++)
+		{
+			activations[0][input] = _mm256_loadu_ps(inputs + input * inputStride + agent);
+		}
+		int current = 0;
+		for (int layer = 0; layer < numberLayers - 1; layer++)
+		{
+			int rows = networkArchitecture[layer];
+			int columns = networkArchitecture[layer + 1];
+			for (int column = 0; column < columns; column++)
+			{
+				__m256 nodePreActivation = _mm256_setzero_ps();
+				for (int row = 0; row < rows; row++)
+				{
+					__m256 weights = _mm256_i32gather_ps(genome + row * columns + column, laneOffsets, 4);
+					nodePreActivation = _mm256_add_ps(nodePreActivation, _mm256_mul_ps(activations[current][row], weights));
+				}
+				activations[1 - current][column] = sigmoid256(nodePreActivation);
+			}
+			genome += rows * columns;
+			current = 1 - current;
+		}
+		int turnLeft = _mm256_movemask_ps(_mm256_cmp_ps(activations[current][0], activations[current][1], _CMP_GE_OQ));
+		for (int lane = 0; lane < 8; lane++)
+		{
+			decisions[agent + lane] = (turnLeft >> lane) & 1;
+		}
+	}
+	forwardScalar(inputs + agent, inputStride, genomes + (size_t)agent * genomeStride, genomeStride, networkArchitecture, count - agent, decisions + agent);
+}
+
+// The AVX-512 equivalent of exp256, using scalef to apply the 2^n scaling
+TARGET_AVX512 static __m512d exp512(__m512d x)
+{
+	x = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(-708.0)), _mm512_set1_pd(708.0));
+	__m512d n = _mm512_roundscale_pd(_mm512_add_pd(_mm512_mul_pd(x, _mm512_set1_pd(1.4426950408889634073599)), _mm512_set1_pd(0.5)), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+	x = _mm512_sub_pd(x, _mm512_mul_pd(n, _mm512_set1_pd(6.93145751953125E-1)));
+	x = _mm512_sub_pd(x, _mm512_mul_pd(n, _mm512_set1_pd(1.42860682030941723212E-6)));
+	__m512d xx = _mm512_mul_pd(x, x);
+	__m512d p = _mm512_set1_pd(1.26177193074810590878E-4);
+	p = _mm512_add_pd(_mm512_mul_pd(p, xx), _mm512_set1_pd(3.02994407707441961300E-2));
+	p = _mm512_add_pd(_mm512_mul_pd(p, xx), _mm512_set1_pd(9.99999999999999999910E-1));
+	p = _mm512_mul_pd(p, x);
+	__m512d q = _mm512_set1_pd(3.00198505138664455042E-6);
+	q = _mm512_add_pd(_mm512_mul_pd(q, xx), _mm512_set1_pd(2.52448340349684104192E-3));
+	q = _mm512_add_pd(_mm512_mul_pd(q, xx), _mm512_set1_pd(2.27265548208155028766E-1));
+	q = _mm512_add_pd(_mm512_mul_pd(q, xx), _mm512_set1_pd(2.00000000000000000009E0));
+	__m512d y = _mm512_add_pd(_mm512_set1_pd(1.0), _mm512_mul_pd(_mm512_set1_pd(2.0), _mm512_div_pd(p, _mm512_sub_pd(q, p))));
+	return _mm512_scalef_pd(y, n);
+}
+
+TARGET_AVX512 static __m256 sigmoid256x(__m256 x)
+{
+	__m512d one = _mm512_set1_pd(1.0);
+	__m512d negated = _mm512_sub_pd(_mm512_setzero_pd(), _mm512_cvtps_pd(x));
+	return _mm512_cvtpd_ps(_mm512_div_pd(one, _mm512_add_pd(one, exp512(negated))));
+}
+
+TARGET_AVX512 static __m512 sigmoid512(__m512 x)
+{
+	__m512 low = _mm512_castps256_ps512(sigmoid256x(_mm512_castps512_ps256(x)));
+	__m256 high = sigmoid256x(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(x), 1)));
+	return _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castps_pd(low), _mm256_castps_pd(high), 1));
+}
+
+// The AVX-512 equivalent of forwardAvx2, evaluating 16 agents at once
+TARGET_AVX512 static void forwardAvx512(const float *inputs, int inputStride, const float *genomes, int genomeStride, const std::vector<int> &networkArchitecture, int count, char *decisions)
+{
+	__m512 activations[2][maxLayerWidth];
+	int numberLayers = networkArchitecture.size();
+	__m512i laneOffsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(genomeStride));
+	int agent = 0;
+	for (; agent + 16 <= count; agent += 16)
+	{
+		const float *genome = genomes + (size_t)agent * genomeStride;
+		for (int input = 0; input < networkArchitecture[0]; input++)
+		{
+			activations[0][input] = _mm512_loadu_ps(inputs + input * inputStride + agent);
+		}
+		int current = 0;
+		for (int layer = 0; layer < numberLayers - 1; layer++)
+		{
+			int rows = networkArchitecture[layer];
+			int columns = networkArchitecture[layer + 1];
+			for (int column = 0; column < columns; column++)
+			{
+				__m512 nodePreActivation = _mm512_setzero_ps();
+				for (int row = 0; row < rows; row++)
+				{
+					__m512 weights = _mm512_i32gather_ps(laneOffsets, genome + row * columns + column, 4);
+					nodePreActivation = _mm512_add_ps(nodePreActivation, _mm512_mul_ps(activations[current][row], weights));
+				}
+				activations[1 - current][column] = sigmoid512(nodePreActivation);
+			}
+			genome += rows * columns;
+			current = 1 - current;
+		}
+		__mmask16 turnLeft = _mm512_cmp_ps_mask(activations[current][0], activations[current][1], _CMP_GE_OQ);
+		for (int lane = 0; lane < 16; lane++)
+		{
+			decisions[agent + lane] = (turnLeft >> lane) & 1;
+		}
+	}
+	forwardAvx2(inputs + agent, inputStride, genomes + (size_t)agent * genomeStride, genomeStride, networkArchitecture, count - agent, decisions + agent);
+}
+#endif
+
+/*
+Evaluates the networks of count agents whose genomes are genomeStride floats apart. Input i
+of agent a is inputs[i * inputStride + a] and each decision is whether the agent turns left
+*/
+void forwardBatch(NetworkKernel kernel, const float *inputs, int inputStride, const float *genomes, int genomeStride, const std::vector<int> &networkArchitecture, int count, char *decisions)
+{
+	switch (kernel)
+	{
+	case ReferenceKernel:
+		forwardReference(inputs, inputStride, genomes, genomeStride, networkArchitecture, count, decisions);
+		break;
+#if SIMD_KERNELS
+	case Avx2Kernel:
+		forwardAvx2(inputs, inputStride, genomes, genomeStride, networkArchitecture, count, decisions);
+		break;
+	case Avx512Kernel:
+		forwardAvx512(inputs, inputStride, genomes, genomeStride, networkArchitecture, count, decisions);
+		break;
+#endif
+	default:
+		forwardScalar(inputs, inputStride, genomes, genomeStride, networkArchitecture, count, decisions);
+	}
+}
+
+// The fastest kernel the CPU supports
+NetworkKernel bestNetworkKernel()
+{
+	if (isNetworkKernelSupported(Avx512Kernel))
+	{
+		return Avx512Kernel;
+	}
+	if (isNetworkKernelSupported(Avx2Kernel))
+	{
+		return Avx2Kernel;
+	}
+	return ScalarKernel;
+}
+
+bool isNetworkKernelSupported(NetworkKernel kernel)
+{
+	switch (kernel)
+	{
+	case Avx2Kernel:
+		return SIMD_KERNELS && cpuSupportsAvx2();
+	case Avx512Kernel:
+		return SIMD_KERNELS && cpuSupportsAvx512() && cpuSupportsAvx2();
+	default:
+		return true;
+	}
+}
+
+const char *getNetworkKernelName(NetworkKernel kernel)
+{
+	switch (kernel)
+	{
+	case ReferenceKernel:
+		return "reference";
+	case ScalarKernel:
+		return "scalar";
+	case Avx2Kernel:
+		return "avx2";
+	case Avx512Kernel:
+		return "avx512";
+	}
+	return "unknown";
+}
+
+// Looks up a kernel by the name getNetworkKernelName gives it
+bool parseNetworkKernel(std::string name, NetworkKernel &kernel)
+{
+	for (NetworkKernel candidate : { ReferenceKernel, ScalarKernel, Avx2Kernel, Avx512Kernel })
+	{
+		if (name == getNetworkKernelName(candidate))
+		{
+			kernel = candidate;
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "FixedMatrix.h"
+
+/*
+Ways of evaluating the agents' networks. The reference kernel multiplies Matrix objects for
+one agent at a time and is what the others are validated against. The remaining kernels
+evaluate a whole batch of agents without allocating: the scalar kernel gives bit identical
+decisions to the reference, while the SIMD kernels put one agent in each vector lane and
+use a fast vectorised sigmoid so they may very occasionally differ on near ties
+*/
+enum NetworkKernel
+{
+	ReferenceKernel,
+	ScalarKernel,
+	Avx2Kernel,
+	Avx512Kernel
+};
+
+// Widest layer the batched kernels support
+const int maxLayerWidth = 32;
+
+// The architecture the agents use, fixed at compile time so it can be evaluated without allocating
+typedef FixedNetwork<3, 5, 2> AgentNetwork;
+
+std::vector<int> getAgentNetworkArchitecture();
+
+bool isAgentNetwork(const std::vector<int>&);
+
+float sigmoid(float);
+
+bool decideReference(const float*, int, const float*, const std::vector<int>&);
+
+bool decideFixed(const float*, int, const float*);
+
+void forwardBatch(NetworkKernel, const float*, int, const float*, int, const std::vector<int>&, int, char*);
+
+NetworkKernel bestNetworkKernel();
+
+bool isNetworkKernelSupported(NetworkKernel);
+
+const char *getNetworkKernelName(NetworkKernel);
+
+bool parseNetworkKernel(std::string, NetworkKernel&);
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include <cstddef>
+#include "Population.h"
+
+Population::Population()
+{
+}
+
+// Creates the given number of agents with zeroed genomes for the network architecture
+Population::Population(int numberAgents, std::vector<int> networkArchitecture)
+	: networkArchitecture(networkArchitecture)
+{
+	for (int layer = 0; layer < (int)networkArchitecture.size() - 1; layer++)
+	{
+		numberWeights += networkArchitecture[layer] * networkArchitecture[layer + 1];
+	}
+	genomeStride = (numberWeights + 7) / 8 * 8;
+	positionX.resize(numberAgents);
+	positionY.resize(numberAgents);
+	heading.resize(numberAgents);
+	fitness.resize(numberAgents);
+	failed.resize(numberAgents);
+	turningLeft.resize(numberAgents);
+	passingCheckPoint.resize(numberAgents);
+	lastCheckPoint.resize(numberAgents);
+	currentCheckPoint.resize(numberAgents);
+	ticks.resize(numberAgents);
+	lastProgressTick.resize(numberAgents);
+	checkPointsPassed.resize(numberAgents);
+	genomes.resize((size_t)numberAgents * genomeStride, 0.0f);
+}
+
+// Number of agents
+int Population::size() const
+{
+	return positionX.size();
+}
+
+// Pointer to the first weight of an agent's genome
+float *Population::getGenome(int agent)
+{
+	return genomes.data() + (size_t)agent * genomeStride;
+}
+
+const float *Population::getGenome(int agent) const
+{
+	return genomes.data() + (size_t)agent * genomeStride;
+}
+
+// Puts an agent back at the start of the map with the state it has at the start of a generation
+void Population::resetAgent(int agent, Vector2 startingPosition, int startingAngle)
+{
+	positionX[agent] = startingPosition.x;
+	positionY[agent] = startingPosition.y;
+	heading[agent] = wrapRotation(startingAngle);
+	fitness[agent] = 1.0f;
+	failed[agent] = false;
+	turningLeft[agent] = false;
+	passingCheckPoint[agent] = false;
+	lastCheckPoint[agent] = 1;
+	currentCheckPoint[agent] = 0;
+	ticks[agent] = 0;
+	lastProgressTick[agent] = 0;
+	checkPointsPassed[agent] = 0;
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include "Geometry.h"
+
+/*
+Structure of arrays store for the whole population. An agent is an index into contiguous
+arrays of its state, and its genome is a fixed stride slice of one flat weight buffer, so
+stepping and breeding sweep memory linearly instead of chasing a pointer per agent. A genome
+holds the weight matrix of each layer row major one after another, padded with zeros to a
+multiple of 8 floats so every genome starts on a whole number of SIMD registers
+*/
+struct Population
+{
+	Population();
+	Population(int, std::vector<int>);
+
+	int size() const;
+
+	float *getGenome(int);
+
+	const float *getGenome(int) const;
+
+	void resetAgent(int, Vector2, int);
+
+	std::vector<int> networkArchitecture;
+	int numberWeights = 0;
+	int genomeStride = 0;
+
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> heading;
+	std::vector<float> fitness;
+	std::vector<char> failed;
+	std::vector<char> turningLeft;
+	std::vector<char> passingCheckPoint;
+	std::vector<int> lastCheckPoint;
+	std::vector<int> currentCheckPoint;
+	// Ticks run, the tick the agent last reached a new check point and how many it has reached
+	std::vector<int> ticks;
+	std::vector<int> lastProgressTick;
+	std::vector<int> checkPointsPassed;
+	std::vector<float> genomes;
+};
\ No newline at end of file
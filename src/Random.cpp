@@ -0,0 +1,90 @@
+#include "Random.h"
+
+/*
+The state is filled from the seed with SplitMix64, as the authors of xoshiro recommend, which
+never leaves it all zero
+*/
+Random::Random(uint64_t seed)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		seed += 0x9E3779B97F4A7C15ULL;
+		uint64_t mixed = seed;
+		mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+		state[i] = mixed ^ (mixed >> 31);
+	}
+}
+
+/*
+Returns a generator continuing this stream and moves this one on by 2^128 numbers, so
+repeated splits give a sequence of independent streams which is the same on every run
+*/
+Random Random::split()
+{
+	Random stream = *this;
+	jump();
+	return stream;
+}
+
+// Copies out the four words of state so the stream can be saved and carried on later
+void Random::getState(uint64_t *words) const
+{
+	for (int i = 0; i < 4; i++)
+	{
+		words[i] = state[i];
+	}
+}
+
+// Carries on a stream from state saved by getState
+void Random::setState(const uint64_t *words)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		state[i] = words[i];
+	}
+}
+
+// Moves the stream on by 2^128 numbers, as if nextBits had been called that many times
+void Random::jump()
+{
+	static const uint64_t jumpPolynomial[] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+	uint64_t jumped[4] = { 0, 0, 0, 0 };
+	for (uint64_t word : jumpPolynomial)
+	{
+		for (int bit = 0; bit < 64; bit++)
+		{
+			if (word & (1ULL << bit))
+			{
+				for (int i = 0; i < 4; i++)
+				{
+					jumped[i] ^= state[i];
+				}
+			}
+			nextBits();
+		}
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		state[i] = jumped[i];
+	}
+}
+
+/*
+Fills values with count numbers from 0 up to but not including 1, as nextFloat would give.
+Each 64 random bits make two numbers, which halves the work of drawing them one at a time
+*/
+void Random::fillFloats(float *values, int count)
+{
+	int i = 0;
+	for (; i + 1 < count; i += 2)
+	{
+		uint64_t bits = nextBits();
+		values[i] = (bits >> 40) * (1.0f / 16777216.0f);
+		values[i + 1] = ((bits >> 8) & 0xFFFFFF) * (1.0f / 16777216.0f);
+	}
+	if (i < count)
+	{
+		values[i] = nextFloat();
+	}
+}
\ No newline at end of file
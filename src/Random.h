@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+The source of random numbers for the genetic algorithm, a xoshiro256** generator. Every
+stream is derived from a run seed, so a run can be repeated exactly, and split gives a new
+stream 2^128 numbers further on which can't overlap with any other in practice. Each island
+or thread is given its own stream, so nothing is shared between threads and the results
+don't depend on how many there are or the order they run in
+*/
+class Random
+{
+public:
+	Random(uint64_t = 0);
+
+	Random split();
+
+	void getState(uint64_t*) const;
+
+	void setState(const uint64_t*);
+
+	uint64_t nextBits()
+	{
+		uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+		uint64_t shifted = state[1] << 17;
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= shifted;
+		state[3] = rotateLeft(state[3], 45);
+		return result;
+	}
+
+	// A whole number from 0 up to but not including limit
+	int nextInt(int limit)
+	{
+		return (int)(((nextBits() >> 32) * (uint64_t)limit) >> 32);
+	}
+
+	// A number from 0 up to but not including 1, with every multiple of 2^-24 equally likely
+	float nextFloat()
+	{
+		return (nextBits() >> 40) * (1.0f / 16777216.0f);
+	}
+
+	void fillFloats(float*, int);
+
+	// Shuffles the values with every order equally likely (a Fisher-Yates shuffle)
+	template<typename T>
+	void shuffle(std::vector<T> &values)
+	{
+		for (int i = (int)values.size() - 1; i > 0; i--)
+		{
+			std::swap(values[i], values[nextInt(i + 1)]);
+		}
+	}
+
+private:
+	static uint64_t rotateLeft(uint64_t value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	void jump();
+
+	uint64_t state[4];
+};
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include "Selection.h"
+
+// Tournaments for parents are between three agents, as in the steady state mode
+static const int parentTournamentSize = 3;
+
+// Orders agents fittest first, with ties broken by index
+static bool isFitter(const RankedAgent &agent1, const RankedAgent &agent2)
+{
+	return agent1.fitness > agent2.fitness || (agent1.fitness == agent2.fitness && agent1.agent < agent2.agent);
+}
+
+static bool isLessFit(const RankedAgent &agent1, const RankedAgent &agent2)
+{
+	return isFitter(agent2, agent1);
+}
+
+// Fills the compact array with every agent in index order
+static void rankAgents(const float *fitness, int numberAgents, std::vector<RankedAgent> &ranked)
+{
+	ranked.resize(numberAgents);
+	for (int agent = 0; agent < numberAgents; agent++)
+	{
+		ranked[agent] = { (int)fitness[agent], agent };
+	}
+}
+
+/*
+Moves the count agents which come first in the given order to the front of the ranked array
+in linear time with nth_element, then sorts just those
+*/
+template<typename Order>
+static void selectFirst(const float *fitness, int numberAgents, int count, std::vector<RankedAgent> &ranked, int *selected, Order order)
+{
+	count = std::max(0, std::min(count, numberAgents));
+	rankAgents(fitness, numberAgents, ranked);
+	std::nth_element(ranked.begin(), ranked.begin() + count, ranked.end(), order);
+	std::sort(ranked.begin(), ranked.begin() + count, order);
+	for (int i = 0; i < count; i++)
+	{
+		selected[i] = ranked[i].agent;
+	}
+}
+
+/*
+Stochastic universal sampling: numberParents equally spaced pointers, starting from a single
+random offset, are laid over the agents' weights end to end and every agent a pointer lands
+on is picked. Each agent is picked close to its expected number of times, which a roulette
+wheel spun once per parent only gives on average. weight(i) is the weight of ranked[i]
+*/
+template<typename Weight>
+static void sampleUniversally(const std::vector<RankedAgent> &ranked, int numberParents, double totalWeight, Weight weight,
+	Random &random, int *parents)
+{
+	int numberAgents = ranked.size();
+	if (numberAgents == 0)
+	{
+		return;
+	}
+	double spacing = totalWeight / numberParents;
+	double pointer = random.nextFloat() * spacing;
+	double cumulativeWeight = 0;
+	int parent = 0;
+	for (int i = 0; i < numberAgents && parent < numberParents; i++)
+	{
+		cumulativeWeight += weight(i);
+		while (parent < numberParents && pointer < cumulativeWeight)
+		{
+			parents[parent++] = ranked[i].agent;
+			pointer += spacing;
+		}
+	}
+	// Rounding can leave the last pointers just past the end
+	while (parent < numberParents)
+	{
+		parents[parent++] = ranked[numberAgents - 1].agent;
+	}
+}
+
+// Writes the indices of the count fittest agents to selected, fittest first
+void selectFittest(const float *fitness, int numberAgents, int count, std::vector<RankedAgent> &ranked, int *selected)
+{
+	selectFirst(fitness, numberAgents, count, ranked, selected, isFitter);
+}
+
+// Writes the indices of the count least fit agents to selected, least fit first
+void selectLeastFit(const float *fitness, int numberAgents, int count, std::vector<RankedAgent> &ranked, int *selected)
+{
+	selectFirst(fitness, numberAgents, count, ranked, selected, isLessFit);
+}
+
+/*
+Picks numberParents parents from the agents' fitnesses and writes their indices to parents.
+Truncation takes the fittest agents once each. Tournament, rank and stochastic universal
+sampling pick with replacement: the fittest of three random agents, or by stochastic universal
+sampling weighted by rank (the fittest of N agents weighs N and the least fit 1) or by
+fitness. Only the rank strategy has to sort the whole population
+*/
+void selectParents(SelectionStrategy strategy, const float *fitness, int numberAgents, int numberParents, Random &random,
+	std::vector<RankedAgent> &ranked, int *parents)
+{
+	if (strategy == TournamentSelection)
+	{
+		for (int parent = 0; parent < numberParents; parent++)
+		{
+			parents[parent] = selectByTournament(fitness, numberAgents, parentTournamentSize, random);
+		}
+	}
+	else if (strategy == RankSelection)
+	{
+		rankAgents(fitness, numberAgents, ranked);
+		std::sort(ranked.begin(), ranked.end(), isFitter);
+		double totalWeight = (double)numberAgents * (numberAgents + 1) / 2;
+		sampleUniversally(ranked, numberParents, totalWeight, [numberAgents](int rank) { return (double)(numberAgents - rank); },
+			random, parents);
+	}
+	else if (strategy == StochasticUniversalSelection)
+	{
+		rankAgents(fitness, numberAgents, ranked);
+		double totalWeight = 0;
+		for (const RankedAgent &agent : ranked)
+		{
+			totalWeight += std::max(0, agent.fitness);
+		}
+		if (totalWeight == 0)
+		{
+			// Every weight is zero so every agent is as likely as any other
+			sampleUniversally(ranked, numberParents, numberAgents, [](int) { return 1.0; }, random, parents);
+			return;
+		}
+		sampleUniversally(ranked, numberParents, totalWeight, [&ranked](int i) { return (double)std::max(0, ranked[i].fitness); },
+			random, parents);
+	}
+	else
+	{
+		numberParents = std::max(0, std::min(numberParents, numberAgents));
+		rankAgents(fitness, numberAgents, ranked);
+		std::nth_element(ranked.begin(), ranked.begin() + numberParents, ranked.end(), isFitter);
+		for (int parent = 0; parent < numberParents; parent++)
+		{
+			parents[parent] = ranked[parent].agent;
+		}
+	}
+}
+
+// The fittest of a few agents picked at random
+int selectByTournament(const float *fitness, int numberAgents, int tournamentSize, Random &random)
+{
+	int best = random.nextInt(numberAgents);
+	for (int i = 1; i < tournamentSize; i++)
+	{
+		int contender = random.nextInt(numberAgents);
+		if (fitness[contender] > fitness[best])
+		{
+			best = contender;
+		}
+	}
+	return best;
+}
+
+const char *getSelectionStrategyName(SelectionStrategy strategy)
+{
+	switch (strategy)
+	{
+	case TruncationSelection:
+		return "truncation";
+	case TournamentSelection:
+		return "tournament";
+	case RankSelection:
+		return "rank";
+	case StochasticUniversalSelection:
+		return "sus";
+	}
+	return "unknown";
+}
+
+// Looks up a strategy by the name getSelectionStrategyName gives it
+bool parseSelectionStrategy(std::string name, SelectionStrategy &strategy)
+{
+	for (SelectionStrategy candidate : { TruncationSelection, TournamentSelection, RankSelection, StochasticUniversalSelection })
+	{
+		if (name == getSelectionStrategyName(candidate))
+		{
+			strategy = candidate;
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
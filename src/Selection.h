@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Random.h"
+
+enum SelectionStrategy
+{
+	TruncationSelection,
+	TournamentSelection,
+	RankSelection,
+	StochasticUniversalSelection
+};
+
+/*
+The compact form agents are ranked in: fitness as the whole number it is reported as and the
+agent's index. Agents are ordered by fitness and then by index so every ranking is unique and
+doesn't depend on the order agents are compared in
+*/
+struct RankedAgent
+{
+	int fitness;
+	int agent;
+};
+
+/*
+Selection works on indices into a population's fitnesses, never on the agents themselves.
+The fittest agents are found with a partial selection, which is linear in the number of
+agents, rather than by sorting the whole population. The ranked array is scratch space kept
+by the caller so selecting allocates nothing once it has grown
+*/
+void selectFittest(const float*, int, int, std::vector<RankedAgent>&, int*);
+
+void selectLeastFit(const float*, int, int, std::vector<RankedAgent>&, int*);
+
+void selectParents(SelectionStrategy, const float*, int, int, Random&, std::vector<RankedAgent>&, int*);
+
+int selectByTournament(const float*, int, int, Random&);
+
+const char *getSelectionStrategyName(SelectionStrategy);
+
+bool parseSelectionStrategy(std::string, SelectionStrategy&);
\ No newline at end of file
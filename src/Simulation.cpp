@@ -0,0 +1,800 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include "Agent.h"
+#include "Genetics.h"
+#include "Instrumentation.h"
+#include "Selection.h"
+#include "Simulation.h"
+#include "Snapshot.h"
+
+// Prints the summary line for a generation which has just finished
+void printStatistics(GenerationStatistics statistics)
+{
+	std::cout << "Generation: " << statistics.generation << "; Greatest Fitness: "
+		<< statistics.maxFitness << "; Average Fitness: " << statistics.averageFitness
+		<< "; Diversity: " << statistics.diversity << "; Weight Variance: " << statistics.weightVariance
+		<< "; Centroid Distance: " << statistics.centroidDistance << '\n';
+}
+
+/*
+Runs count agents with the given genomes (genomeStride floats apart) on the case's track from
+its starting pose until they have all failed or been stopped by the termination policy and
+writes their fitnesses. Agents don't affect each other so this gives the
+fitnesses they would have had as part of any population, which lets generations be evaluated
+in pieces elsewhere
+*/
+void evaluateGenomes(const EvaluationCase &evaluationCase, const TerminationPolicy &policy, const float *genomes, int genomeStride, int count, float *fitnesses)
+{
+	const Track &track = *evaluationCase.track;
+	Population population(count, getAgentNetworkArchitecture());
+	std::vector<char> checkPointsReached(track.getCheckPoints().size());
+	for (int agent = 0; agent < count; agent++)
+	{
+		population.resetAgent(agent, evaluationCase.startingPosition, evaluationCase.startingAngle);
+		std::copy(genomes + (size_t)agent * genomeStride, genomes + (size_t)agent * genomeStride + population.numberWeights,
+			population.getGenome(agent));
+	}
+	int numberFailed = 0;
+	while (numberFailed < count)
+	{
+		for (int agent = 0; agent < count; agent++)
+		{
+			if (population.failed[agent]) continue;
+			if (stepAgent(population, agent, track, policy, checkPointsReached.data())) numberFailed++;
+		}
+	}
+	std::copy(population.fitness.begin(), population.fitness.end(), fitnesses);
+}
+
+/*
+The track is shared rather than copied so any number of simulations can run on it. A thread
+count of 0 uses every hardware thread. The genetic algorithm draws its random numbers from
+the given stream, so a simulation with the same seed always evolves the same way
+*/
+Simulation::Simulation(std::shared_ptr<const Track> track, int numberThreads, Random random)
+	: track(track), random(random), diversityRandom(this->random.split()), evaluationCases({ makeEvaluationCase(track) }),
+	threadPool(numberThreads)
+{
+	checkPointsReached.resize(track->getCheckPoints().size(), false);
+	population = Population(track->getNumberAgents(), networkArchitecture);
+
+	// Initialising the network for each agent
+	for (int agent = 0; agent < population.size(); agent++)
+	{
+		population.resetAgent(agent, track->getStartingPosition(), track->getStartingAngle());
+		float *genome = population.getGenome(agent);
+		for (int weight = 0; weight < population.numberWeights; weight++)
+		{
+			genome[weight] = this->random.nextFloat() * 2 - 1;
+		}
+	}
+}
+
+Simulation::~Simulation()
+{
+}
+
+/*
+Advances every agent which hasn't failed by a single tick. Agents don't interact within a
+tick so they are stepped in parallel, with each chunk counting its own failures and the
+check points it reached. These are then combined in chunk order so the result doesn't
+depend on the number of threads. When evaluating on several cases, the next case is started
+as soon as every agent has failed on the current one
+*/
+void Simulation::step()
+{
+	int numberAgents = population.size();
+	int numberChunks = (numberAgents + agentsPerChunk - 1) / agentsPerChunk;
+	int numberCheckPointLines = checkPointsReached.size();
+	if (recordingTelemetry && generationTicks++ % liveAgentSampleTicks == 0)
+	{
+		liveAgents.push_back(numberAgents - numberFailed);
+	}
+	chunkFailures.assign(numberChunks, 0);
+	chunkCheckPointsReached.assign(numberChunks * numberCheckPointLines, false);
+	chunkNetworkMismatches.assign(numberChunks, 0);
+	networkInputs.resize(networkArchitecture[0] * numberAgents);
+	networkDecisions.resize(numberAgents);
+	threadPool.parallelFor(numberAgents, agentsPerChunk, [this](int begin, int end, int chunk)
+	{
+		stepAgents(begin, end, chunk);
+	});
+	for (int chunk = 0; chunk < numberChunks; chunk++)
+	{
+		numberFailed += chunkFailures[chunk];
+		networkMismatches += chunkNetworkMismatches[chunk];
+		for (int checkPoint = 0; checkPoint < numberCheckPointLines; checkPoint++)
+		{
+			if (chunkCheckPointsReached[chunk * numberCheckPointLines + checkPoint])
+			{
+				checkPointsReached[checkPoint] = true;
+			}
+		}
+	}
+	if (evaluationCases.size() > 1 && numberFailed == numberAgents)
+	{
+		finishCase();
+	}
+}
+
+/*
+Steps the agents in [begin, end), recording the results against the given chunk. The sensor
+inputs of every live agent in the chunk are gathered first so all of their networks can be
+evaluated in one batch before the agents are moved. The fused step instead runs each agent's
+whole tick in one pass, giving the same results
+*/
+void Simulation::stepAgents(int begin, int end, int chunk)
+{
+	int numberAgents = population.size();
+	const SpatialGrid &walls = track->getWalls();
+	const std::vector<Segment> &checkPoints = track->getCheckPoints();
+	char *checkPointsReachedByChunk = chunkCheckPointsReached.data() + chunk * checkPointsReached.size();
+	if (fusedStep)
+	{
+		for (int currentAgent = begin; currentAgent < end; currentAgent++)
+		{
+			if (population.failed[currentAgent]) continue;
+			if (stepAgent(population, currentAgent, *track, terminationPolicy, checkPointsReachedByChunk)) chunkFailures[chunk] += 1;
+		}
+		return;
+	}
+	for (int currentAgent = begin; currentAgent < end; currentAgent++)
+	{
+		if (population.failed[currentAgent]) continue;
+		senseAgent(population, currentAgent, walls, networkInputs.data() + currentAgent, numberAgents);
+	}
+	{
+		INSTRUMENT_SCOPE(InferenceTimer);
+		forwardBatch(networkKernel, networkInputs.data() + begin, numberAgents, population.getGenome(begin), population.genomeStride,
+			networkArchitecture, end - begin, networkDecisions.data() + begin);
+	}
+	for (int currentAgent = begin; currentAgent < end; currentAgent++)
+	{
+		if (population.failed[currentAgent]) continue;
+		if (validateNetwork && networkDecisions[currentAgent] != decideReference(networkInputs.data() + currentAgent, numberAgents,
+			population.getGenome(currentAgent), networkArchitecture))
+		{
+			chunkNetworkMismatches[chunk] += 1;
+		}
+		moveAgent(population, currentAgent, networkDecisions[currentAgent]);
+		for (int currentCheckPoint = 0; currentCheckPoint < (int)checkPoints.size(); currentCheckPoint++)
+		{
+			const Segment &checkPoint = checkPoints[currentCheckPoint];
+			if (updateAgentFitness(population, currentAgent, checkPoint.start, checkPoint.end, currentCheckPoint))
+			{
+				checkPointsReachedByChunk[currentCheckPoint] = true;
+			}
+		}
+		if (checkAgentFail(population, currentAgent, walls)
+			|| checkAgentTermination(population, currentAgent, terminationPolicy, checkPoints.size()))
+		{
+			chunkFailures[chunk] += 1;
+		}
+	}
+}
+
+bool Simulation::isGenerationComplete()
+{
+	return numberFailed == population.size();
+}
+
+/*
+This is the genetic algorithm implementation. The fitness is always mutated by being multiplied
+by a random value between 0.9 and 1.1. The best performing agents are then picked out without
+sorting the rest and by default (see selectParents for the other strategies) the top 20% of
+agents become parents (so there will be N/10 "couples"). This will each create 8 children each 
+and these offspring will have a 10% hard mutation rate. A hard mutation means that the weights
+that are muated are mutated to a random value. It also takes the top 10% of parents and uses 
+the idea of elitism to send them through to the next generation. The final 10% comes from
+mutated versions of the elite parents with a 5% soft mutation rate. A soft mutation is where
+each of the weights that are mutated are altered by a small delta. This algorithm ensures a 
+few key things:
+
+1.	The high number (80%) of agents that have been genetically spliced and mutated at such a
+	high rate ensures that genetic diversity is kept high and the agents don't converge on a
+	solution prematurely. Through testing I found that the diversity metric I made up works
+	as an excellent indicator of how the algorithm will perform over hundreds of generations.
+	If the genetic diversity drops by over an order of magnitude in the first 20 generations
+	then it is very unlikely that the agents will mutate sufficiently and this is indicitive
+	of a poor algorithm.
+
+2.	The agents will not regress. This is important for this task and elitism is how this is
+	solved but too great a bearing on elitism can lead to the diversity dropping. This is why
+	10% of the agents are carried through as I found this is a decent compromise to allow for
+	a stable diversity but also the population being carried in the right direction
+
+3.	There will often be incremental progress from generation to generation even if there isn't
+	a breakthrough. This is created through the mutated top 10% as these are very similar to the
+	most successful agents but have slight variations which could cause a minor improvement.
+
+When the population isn't a multiple of 10 the first couples have one more child each, so the
+population never shrinks. It must have at least minNumberAgents agents
+*/
+GenerationStatistics Simulation::nextGeneration()
+{
+	int numberAgents = population.size();
+	numberFailed = 0;
+	numberEvaluations += (long long)numberAgents * evaluationCases.size();
+	DiversityStatistics diversity = diversityMeter.measure(diversityMode, geneticsKernel, population.getGenome(0), population.genomeStride,
+		population.numberWeights, numberAgents, diversityRandom, threadPool);
+	if (recordingTelemetry)
+	{
+		telemetryFitness.assign(population.fitness.begin(), population.fitness.end());
+		finishTelemetry();
+	}
+	int maxFitness = 0;
+	int averageFitness = 0;
+	for (int currentAgent = 0; currentAgent < numberAgents; currentAgent++)
+	{
+		int currentFitness = population.fitness[currentAgent];
+		averageFitness += currentFitness;
+		if (currentFitness > maxFitness)
+		{
+			maxFitness = currentFitness;
+			recordBest(population.fitness[currentAgent], population.getGenome(currentAgent));
+		}
+		// Mutate fitness by random amount to add more random selection
+		population.fitness[currentAgent] *= random.nextFloat() / 5 + 0.9f;
+	}
+	averageFitness /= std::max(numberAgents, 1);
+	GenerationStatistics statistics = { currentGeneration++, maxFitness, averageFitness, diversity.meanDistance, diversity.weightVariance,
+		diversity.centroidDistance };
+
+	int numberParents = numberAgents / 5;
+	int numberElite = numberAgents / 10;
+	int numberCouples = numberParents / 2;
+	int numberChildren = numberAgents - 2 * numberElite;
+	// Agents are selected by their indices rather than moving any of their state
+	{
+		INSTRUMENT_SCOPE(SelectionTimer);
+		ranking.resize(numberElite);
+		selectFittest(population.fitness.data(), numberAgents, numberElite, rankedAgents, ranking.data());
+		parents.resize(numberParents);
+		selectParents(selectionStrategy, population.fitness.data(), numberAgents, numberParents, random, rankedAgents, parents.data());
+	}
+	INSTRUMENT_SCOPE(BreedingTimer);
+	// The back buffer only needs allocating when the size of the population changes
+	if (nextPopulation.size() != 2 * numberElite + numberChildren)
+	{
+		nextPopulation = Population(2 * numberElite + numberChildren, networkArchitecture);
+	}
+	// The elite come first, followed by their copies and then the children, so each is bred in one batch
+	for (int currentAgent = 0; currentAgent < numberElite; currentAgent++)
+	{
+		const float *genome = population.getGenome(ranking[currentAgent]);
+		std::copy(genome, genome + population.genomeStride, nextPopulation.getGenome(currentAgent));
+		std::copy(genome, genome + population.genomeStride, nextPopulation.getGenome(numberElite + currentAgent));
+	}
+	mutateBatch(geneticsKernel, nextPopulation.getGenome(numberElite), numberElite, population.genomeStride, population.numberWeights, 5, SoftMutation, random);
+	// Creates random couples 
+	random.shuffle(parents);
+	childParents.clear();
+	for (int child = 0; child < numberChildren; child++)
+	{
+		int couple = child / 8 % numberCouples;
+		childParents.push_back(parents[2 * couple]);
+		childParents.push_back(parents[2 * couple + 1]);
+	}
+	float *children = nextPopulation.getGenome(2 * numberElite);
+	crossBatch(geneticsKernel, population.getGenome(0), childParents.data(), numberChildren, children, population.genomeStride,
+		networkArchitecture, LayerCrossover, random);
+	mutateBatch(geneticsKernel, children, numberChildren, population.genomeStride, population.numberWeights, 10, HardMutation, random);
+	// The old generation becomes the back buffer for the one after
+	std::swap(population, nextPopulation);
+	startCase(0);
+	return statistics;
+}
+
+/*
+Starts the agents on the given case from its pose, with none of its check points reached.
+Only the track's check points are sized by the case, so switching cases allocates nothing
+once every track has been used
+*/
+void Simulation::startCase(int evaluationCase)
+{
+	currentCase = evaluationCase;
+	const EvaluationCase &current = evaluationCases[currentCase];
+	track = current.track;
+	checkPointsReached.assign(track->getCheckPoints().size(), false);
+	for (int agent = 0; agent < population.size(); agent++)
+	{
+		population.resetAgent(agent, current.startingPosition, current.startingAngle);
+	}
+	numberFailed = 0;
+}
+
+/*
+Keeps the fitnesses of the case every agent has just failed on and starts the next one. Once
+the last case is done the fitnesses are aggregated into the population's, which leaves the
+generation complete and ready to breed from
+*/
+void Simulation::finishCase()
+{
+	int numberAgents = population.size();
+	caseFitness.resize((size_t)numberAgents * evaluationCases.size());
+	std::copy(population.fitness.begin(), population.fitness.end(), caseFitness.begin() + (size_t)currentCase * numberAgents);
+	if (currentCase + 1 < (int)evaluationCases.size())
+	{
+		startCase(currentCase + 1);
+		return;
+	}
+	aggregateFitness(fitnessAggregation, caseFitness.data(), evaluationCases.size(), numberAgents, population.fitness.data());
+}
+
+/*
+Records the telemetry of a generation which has just finished from the fitnesses gathered in
+telemetryFitness, which are sorted to find the percentiles, and starts on the next
+*/
+void Simulation::finishTelemetry()
+{
+	telemetry.evaluations = numberEvaluations;
+	telemetry.ticks = generationTicks;
+	std::sort(telemetryFitness.begin(), telemetryFitness.end());
+	int count = telemetryFitness.size();
+	telemetry.minFitness = count > 0 ? telemetryFitness[0] : 0;
+	for (int i = 0; i < numberFitnessPercentiles; i++)
+	{
+		telemetry.percentiles[i] = count > 0 ? telemetryFitness[(size_t)((count - 1) * fitnessPercentiles[i] / 100.0 + 0.5)] : 0;
+	}
+	std::swap(telemetry.liveAgents, liveAgents);
+	liveAgents.clear();
+	telemetryFitness.clear();
+	generationTicks = 0;
+}
+
+// Steps the population until every agent has failed and then breeds the next generation
+GenerationStatistics Simulation::runGeneration()
+{
+	while (!isGenerationComplete())
+	{
+		step();
+	}
+	return nextGeneration();
+}
+
+// Getter
+const Population& Simulation::getPopulation()
+{
+	return population;
+}
+
+// Getter
+const Track& Simulation::getTrack()
+{
+	return *track;
+}
+
+// Whether any agent has reached the check point during the current generation
+bool Simulation::isCheckPointReached(int checkPointIndex)
+{
+	return checkPointsReached[checkPointIndex];
+}
+
+/*
+Selects the kernel used to evaluate the networks. When validating, every decision is also
+made by the reference kernel and the number of times they disagree is counted
+*/
+void Simulation::setNetworkKernel(NetworkKernel kernel, bool validate)
+{
+	networkKernel = kernel;
+	validateNetwork = validate;
+}
+
+// Number of decisions where the selected kernel disagreed with the reference kernel
+long long Simulation::getNetworkMismatches()
+{
+	return networkMismatches;
+}
+
+/*
+Selects whether each agent's tick runs as a single fused pass or as separate batched steps.
+The fused step evaluates networks one agent at a time so the network kernel isn't used
+*/
+void Simulation::setFusedStep(bool fused)
+{
+	fusedStep = fused;
+}
+
+// Selects how parents are picked from each generation (see selectParents)
+void Simulation::setSelectionStrategy(SelectionStrategy strategy)
+{
+	selectionStrategy = strategy;
+}
+
+// Selects whether diversity is measured over every pair of agents or estimated from a sample
+void Simulation::setDiversityMode(DiversityMode mode)
+{
+	diversityMode = mode;
+}
+
+/*
+Scores every genome on each of the cases (tracks and starting poses) rather than only on the
+track the simulation was made with, combining its fitnesses on them with the given
+aggregation. The population keeps its size. The agents start again on the first case, so
+this should be set before a generation is run. The steady state mode can't be run with more
+than one case
+*/
+void Simulation::setEvaluationCases(std::vector<EvaluationCase> cases, FitnessAggregation aggregation)
+{
+	evaluationCases = cases;
+	fitnessAggregation = aggregation;
+	startCase(0);
+}
+
+// Getter
+const std::vector<EvaluationCase> &Simulation::getEvaluationCases()
+{
+	return evaluationCases;
+}
+
+// Getter
+FitnessAggregation Simulation::getFitnessAggregation()
+{
+	return fitnessAggregation;
+}
+
+// Selects the kernel used to mutate and cross genomes, which all breed the same children
+void Simulation::setGeneticsKernel(GeneticsKernel kernel)
+{
+	geneticsKernel = kernel;
+}
+
+/*
+Copies the genomes and fitnesses of the fittest agents of a generation which has finished
+into genomes (one genome stride apart) and fitnesses, for sending to another population
+*/
+void Simulation::selectMigrants(int numberMigrants, std::vector<float> &genomes, std::vector<float> &fitnesses)
+{
+	numberMigrants = std::min(numberMigrants, population.size());
+	ranking.resize(numberMigrants);
+	selectFittest(population.fitness.data(), population.size(), numberMigrants, rankedAgents, ranking.data());
+	for (int migrant = 0; migrant < numberMigrants; migrant++)
+	{
+		const float *genome = population.getGenome(ranking[migrant]);
+		genomes.insert(genomes.end(), genome, genome + population.genomeStride);
+		fitnesses.push_back(population.fitness[ranking[migrant]]);
+	}
+}
+
+/*
+Replaces the least fit agents of a generation which has finished with migrants from another
+population (as given by selectMigrants) so they take part in breeding the next generation
+*/
+void Simulation::acceptMigrants(const std::vector<float> &genomes, const std::vector<float> &fitnesses)
+{
+	int numberMigrants = std::min((int)fitnesses.size(), population.size());
+	ranking.resize(numberMigrants);
+	selectLeastFit(population.fitness.data(), population.size(), numberMigrants, rankedAgents, ranking.data());
+	for (int migrant = 0; migrant < numberMigrants; migrant++)
+	{
+		int agent = ranking[migrant];
+		std::copy(genomes.begin() + migrant * population.genomeStride, genomes.begin() + (migrant + 1) * population.genomeStride,
+			population.getGenome(agent));
+		population.fitness[agent] = fitnesses[migrant];
+	}
+}
+
+/*
+Finishes the current generation with fitnesses evaluated elsewhere (such as by
+evaluateGenomes), one per agent, so the next generation can be bred from them
+*/
+void Simulation::completeGeneration(const std::vector<float> &fitnesses)
+{
+	std::copy(fitnesses.begin(), fitnesses.end(), population.fitness.begin());
+	std::fill(population.failed.begin(), population.failed.end(), true);
+	numberFailed = population.size();
+}
+
+/*
+The steady state (asynchronous) genetic algorithm. Rather than waiting for the whole
+population to fail, each agent is scored as soon as it fails and its place is taken straight
+away by a child bred from the elite pool, the fittest evaluations seen so far. So every agent
+is always running and the few long lived agents at the end of a generation never leave the
+threads idle. Parents are picked by tournaments within the elite pool and children are bred
+as in the generational algorithm: most are crossed from two parents and hard mutated at a
+rate of 10% and the rest are copies of one parent soft mutated at a rate of 5%. This runs
+until the given number of agents have been evaluated and returns their statistics, where
+the generation is the number of these epochs. It is an alternative to nextGeneration and the
+two shouldn't be mixed on one simulation. Each agent is scored on one case only, as a
+replacement starts straight away, so more than one evaluation case is rejected
+*/
+GenerationStatistics Simulation::runSteadyState(int epochEvaluations)
+{
+	if (evaluationCases.size() > 1)
+	{
+		throw std::logic_error("the steady state mode only runs on one evaluation case");
+	}
+	int numberAgents = population.size();
+	int evaluated = 0;
+	int maxFitness = 0;
+	long long totalFitness = 0;
+	while (evaluated < epochEvaluations)
+	{
+		step();
+		// Failed agents are replaced in index order so a run doesn't depend on the number of threads
+		for (int agent = 0; agent < numberAgents && evaluated < epochEvaluations; agent++)
+		{
+			if (!population.failed[agent]) continue;
+			int fitness = population.fitness[agent];
+			maxFitness = std::max(maxFitness, fitness);
+			totalFitness += fitness;
+			evaluated++;
+			if (recordingTelemetry)
+			{
+				telemetryFitness.push_back(population.fitness[agent]);
+			}
+			recordEvaluation(agent);
+			breedAgent(agent);
+			numberFailed--;
+		}
+	}
+	numberEvaluations += evaluated;
+	DiversityStatistics diversity = diversityMeter.measure(diversityMode, geneticsKernel, elitePoolGenomes.data(), population.genomeStride,
+		population.numberWeights, elitePoolFitness.size(), diversityRandom, threadPool);
+	std::fill(checkPointsReached.begin(), checkPointsReached.end(), false);
+	if (recordingTelemetry)
+	{
+		finishTelemetry();
+	}
+	return { currentGeneration++, maxFitness, (int)(totalFitness / evaluated), diversity.meanDistance, diversity.weightVariance,
+		diversity.centroidDistance };
+}
+
+/*
+Adds a failed agent to the elite pool, which holds a fifth of the population, if it is
+fitter than the least fit agent in it
+*/
+void Simulation::recordEvaluation(int agent)
+{
+	recordBest(population.fitness[agent], population.getGenome(agent));
+	int poolCapacity = std::max(2, population.size() / 5);
+	int stride = population.genomeStride;
+	const float *genome = population.getGenome(agent);
+	if ((int)elitePoolFitness.size() < poolCapacity)
+	{
+		elitePoolGenomes.insert(elitePoolGenomes.end(), genome, genome + stride);
+		elitePoolFitness.push_back(population.fitness[agent]);
+		return;
+	}
+	int worst = std::min_element(elitePoolFitness.begin(), elitePoolFitness.end()) - elitePoolFitness.begin();
+	if (population.fitness[agent] > elitePoolFitness[worst])
+	{
+		std::copy(genome, genome + stride, elitePoolGenomes.begin() + (size_t)worst * stride);
+		elitePoolFitness[worst] = population.fitness[agent];
+	}
+}
+
+// Replaces an agent with a new child of the elite pool and puts it back at the start
+void Simulation::breedAgent(int agent)
+{
+	INSTRUMENT_SCOPE(BreedingTimer);
+	int stride = population.genomeStride;
+	float *child = population.getGenome(agent);
+	if (elitePoolFitness.size() < 2)
+	{
+		for (int weight = 0; weight < population.numberWeights; weight++)
+		{
+			child[weight] = random.nextFloat() * 2 - 1;
+		}
+	}
+	else if (random.nextInt(10) == 0)
+	{
+		const float *parent = elitePoolGenomes.data() + (size_t)selectByTournament(elitePoolFitness.data(), elitePoolFitness.size(), tournamentSize, random) * stride;
+		std::copy(parent, parent + stride, child);
+		mutateBatch(geneticsKernel, child, 1, stride, population.numberWeights, 5, SoftMutation, random);
+	}
+	else
+	{
+		int parents[2];
+		parents[0] = selectByTournament(elitePoolFitness.data(), elitePoolFitness.size(), tournamentSize, random);
+		parents[1] = selectByTournament(elitePoolFitness.data(), elitePoolFitness.size(), tournamentSize, random);
+		crossBatch(geneticsKernel, elitePoolGenomes.data(), parents, 1, child, stride, networkArchitecture, LayerCrossover, random);
+		mutateBatch(geneticsKernel, child, 1, stride, population.numberWeights, 10, HardMutation, random);
+	}
+	population.resetAgent(agent, evaluationCases[0].startingPosition, evaluationCases[0].startingAngle);
+}
+
+// Number of agents which have been run to completion
+long long Simulation::getNumberEvaluations()
+{
+	return numberEvaluations;
+}
+
+// Sets the limits which stop agents early (see TerminationPolicy)
+void Simulation::setTerminationPolicy(TerminationPolicy policy)
+{
+	terminationPolicy = policy;
+}
+
+// Getter
+const TerminationPolicy &Simulation::getTerminationPolicy()
+{
+	return terminationPolicy;
+}
+
+// Getter
+int Simulation::getGeneration()
+{
+	return currentGeneration;
+}
+
+// Keeps a copy of a genome if it is the fittest seen so far
+void Simulation::recordBest(float fitness, const float *genome)
+{
+	if (fitness > bestFitness)
+	{
+		bestFitness = fitness;
+		bestGenome.assign(genome, genome + population.genomeStride);
+	}
+}
+
+// The fitness of the fittest agent seen so far
+float Simulation::getBestFitness()
+{
+	return bestFitness;
+}
+
+// The genome of the fittest agent seen so far, empty before any agent has finished
+const std::vector<float> &Simulation::getBestGenome()
+{
+	return bestGenome;
+}
+
+/*
+Turns on recording the telemetry of each generation (see GenerationTelemetry), starting with
+the next one to run
+*/
+void Simulation::setTelemetry(bool record)
+{
+	recordingTelemetry = record;
+	liveAgents.clear();
+	telemetryFitness.clear();
+	generationTicks = 0;
+}
+
+// The telemetry of the last generation to finish, if it's being recorded
+const GenerationTelemetry &Simulation::getGenerationTelemetry()
+{
+	return telemetry;
+}
+
+/*
+The fixed size part of a simulation's record in a snapshot. It is followed by the arrays of
+the population's state in the order Population declares them, which check points have been
+reached, the elite pool and the best genome
+*/
+struct SimulationRecord
+{
+	int32_t generation;
+	int32_t numberAgents;
+	int32_t numberFailed;
+	int32_t numberCheckPoints;
+	int64_t numberEvaluations;
+	uint64_t random[4];
+	uint64_t diversityRandom[4];
+	float bestFitness;
+	int32_t reserved;
+};
+
+/*
+Writes everything the simulation needs to carry on exactly where it is into a snapshot, as
+one simulation's record. The settings (kernels, strategies and the termination policy)
+aren't saved, so a run must be resumed with the ones it was started with
+*/
+void Simulation::saveState(SnapshotWriter &writer)
+{
+	SimulationRecord record = {};
+	record.generation = currentGeneration;
+	record.numberAgents = population.size();
+	record.numberFailed = numberFailed;
+	record.numberCheckPoints = checkPointsReached.size();
+	record.numberEvaluations = numberEvaluations;
+	random.getState(record.random);
+	diversityRandom.getState(record.diversityRandom);
+	record.bestFitness = bestFitness;
+	writer.write(&record, sizeof(record));
+	writer.writeArray(population.positionX);
+	writer.writeArray(population.positionY);
+	writer.writeArray(population.heading);
+	writer.writeArray(population.fitness);
+	writer.writeArray(population.failed);
+	writer.writeArray(population.turningLeft);
+	writer.writeArray(population.passingCheckPoint);
+	writer.writeArray(population.lastCheckPoint);
+	writer.writeArray(population.currentCheckPoint);
+	writer.writeArray(population.ticks);
+	writer.writeArray(population.lastProgressTick);
+	writer.writeArray(population.checkPointsPassed);
+	writer.writeArray(population.genomes);
+	writer.writeArray(checkPointsReached);
+	writer.writeArray(elitePoolGenomes);
+	writer.writeArray(elitePoolFitness);
+	writer.writeArray(bestGenome);
+}
+
+/*
+Carries on from a simulation's record in a snapshot, which must be of agents with the same
+network on a track with the same number of check points. Returns false (with the reason in
+the reader's error) if it can't be used, in which case the simulation may be part restored
+*/
+bool Simulation::restoreState(SnapshotReader &reader)
+{
+	const SnapshotHeader &header = reader.getHeader();
+	if (reader.getArchitecture() != networkArchitecture || (int)header.numberWeights != population.numberWeights
+		|| (int)header.genomeStride != population.genomeStride)
+	{
+		return reader.fail("The snapshot's agents have a different network");
+	}
+	SimulationRecord record;
+	if (!reader.read(&record, sizeof(record)))
+	{
+		return false;
+	}
+	if (record.numberCheckPoints != (int)checkPointsReached.size())
+	{
+		return reader.fail("The snapshot was taken on a track with a different number of check points");
+	}
+	if (record.numberAgents < 0 || record.numberFailed < 0 || record.numberFailed > record.numberAgents)
+	{
+		return reader.fail("The snapshot's population is corrupt");
+	}
+	if (record.numberAgents != population.size())
+	{
+		population = Population(record.numberAgents, networkArchitecture);
+	}
+	size_t numberAgents = record.numberAgents;
+	bool read = reader.readArray(population.positionX.data(), numberAgents)
+		&& reader.readArray(population.positionY.data(), numberAgents)
+		&& reader.readArray(population.heading.data(), numberAgents)
+		&& reader.readArray(population.fitness.data(), numberAgents)
+		&& reader.readArray(population.failed.data(), numberAgents)
+		&& reader.readArray(population.turningLeft.data(), numberAgents)
+		&& reader.readArray(population.passingCheckPoint.data(), numberAgents)
+		&& reader.readArray(population.lastCheckPoint.data(), numberAgents)
+		&& reader.readArray(population.currentCheckPoint.data(), numberAgents)
+		&& reader.readArray(population.ticks.data(), numberAgents)
+		&& reader.readArray(population.lastProgressTick.data(), numberAgents)
+		&& reader.readArray(population.checkPointsPassed.data(), numberAgents)
+		&& reader.readArray(population.genomes.data(), population.genomes.size())
+		&& reader.readArray(checkPointsReached.data(), checkPointsReached.size())
+		&& reader.readArray(elitePoolGenomes)
+		&& reader.readArray(elitePoolFitness)
+		&& reader.readArray(bestGenome);
+	if (!read)
+	{
+		return false;
+	}
+	if (elitePoolGenomes.size() != elitePoolFitness.size() * population.genomeStride
+		|| (!bestGenome.empty() && (int)bestGenome.size() != population.genomeStride))
+	{
+		return reader.fail("The snapshot's elite pool or best genome is corrupt");
+	}
+	currentGeneration = record.generation;
+	numberFailed = record.numberFailed;
+	numberEvaluations = record.numberEvaluations;
+	random.setState(record.random);
+	diversityRandom.setState(record.diversityRandom);
+	bestFitness = record.bestFitness;
+	return true;
+}
+
+// Snapshots just this simulation, writing it to the given path in the background
+void Simulation::saveSnapshot(SnapshotWriter &writer, std::string path)
+{
+	writer.begin(1, networkArchitecture, population.numberWeights, population.genomeStride);
+	saveState(writer);
+	writer.save(path);
+}
+
+// Carries on from a snapshot of a single simulation (see restoreState)
+bool Simulation::restoreSnapshot(SnapshotReader &reader)
+{
+	if (reader.getHeader().numberSimulations != 1)
+	{
+		return reader.fail("The snapshot holds " + std::to_string(reader.getHeader().numberSimulations) + " simulations, not 1");
+	}
+	return restoreState(reader);
+}
\ No newline at end of file
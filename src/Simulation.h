@@ -0,0 +1,195 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "Agent.h"
+#include "Diversity.h"
+#include "Evaluation.h"
+#include "Genetics.h"
+#include "Network.h"
+#include "Population.h"
+#include "Random.h"
+#include "Selection.h"
+#include "Snapshot.h"
+#include "Telemetry.h"
+#include "ThreadPool.h"
+#include "Track.h"
+
+struct GenerationStatistics
+{
+	int generation;
+	int maxFitness;
+	int averageFitness;
+	double diversity;
+	double weightVariance;
+	double centroidDistance;
+};
+
+void printStatistics(GenerationStatistics);
+
+void evaluateGenomes(const EvaluationCase&, const TerminationPolicy&, const float*, int, int, float*);
+
+/*
+The simulation core which owns the population and runs the physics, sensing and genetic
+algorithm. It has no dependency on SFML so it can be driven as fast as the CPU allows by
+the headless runner or sampled at display rate by the viewer. A generation can be scored on
+several evaluation cases, but the steady state mode only runs on one and throws
+std::logic_error if given more
+*/
+class Simulation
+{
+public:
+	Simulation(std::shared_ptr<const Track>, int = 1, Random = Random());
+	~Simulation();
+
+	void step();
+
+	bool isGenerationComplete();
+
+	GenerationStatistics nextGeneration();
+
+	GenerationStatistics runGeneration();
+
+	const Population& getPopulation();
+
+	const Track& getTrack();
+
+	bool isCheckPointReached(int);
+
+	int getGeneration();
+
+	void setNetworkKernel(NetworkKernel, bool = false);
+
+	long long getNetworkMismatches();
+
+	void setFusedStep(bool);
+
+	void setGeneticsKernel(GeneticsKernel);
+
+	void setSelectionStrategy(SelectionStrategy);
+
+	void setDiversityMode(DiversityMode);
+
+	void setEvaluationCases(std::vector<EvaluationCase>, FitnessAggregation = MeanFitness);
+
+	const std::vector<EvaluationCase> &getEvaluationCases();
+
+	FitnessAggregation getFitnessAggregation();
+
+	void selectMigrants(int, std::vector<float>&, std::vector<float>&);
+
+	void acceptMigrants(const std::vector<float>&, const std::vector<float>&);
+
+	void completeGeneration(const std::vector<float>&);
+
+	GenerationStatistics runSteadyState(int);
+
+	long long getNumberEvaluations();
+
+	void setTerminationPolicy(TerminationPolicy);
+
+	const TerminationPolicy &getTerminationPolicy();
+
+	float getBestFitness();
+
+	const std::vector<float> &getBestGenome();
+
+	void setTelemetry(bool);
+
+	const GenerationTelemetry &getGenerationTelemetry();
+
+	void saveState(SnapshotWriter&);
+
+	bool restoreState(SnapshotReader&);
+
+	void saveSnapshot(SnapshotWriter&, std::string);
+
+	bool restoreSnapshot(SnapshotReader&);
+
+private:
+	void stepAgents(int, int, int);
+
+	void recordEvaluation(int);
+
+	void breedAgent(int);
+
+	void recordBest(float, const float*);
+
+	void startCase(int);
+
+	void finishCase();
+
+	void finishTelemetry();
+
+	// The track of the case being evaluated
+	std::shared_ptr<const Track> track;
+	Random random;
+	// Diversity is measured with a stream of its own so the way it is measured can't change evolution
+	Random diversityRandom;
+	TerminationPolicy terminationPolicy;
+	std::vector<int> networkArchitecture = getAgentNetworkArchitecture();
+	Population population;
+	std::vector<char> checkPointsReached;
+	int numberFailed = 0;
+	int currentGeneration = 1;
+
+	/*
+	Each generation is evaluated on every case in turn, so only the current case's track is in
+	use at a time, and the fitnesses on each are kept (case major) until they are aggregated
+	*/
+	std::vector<EvaluationCase> evaluationCases;
+	FitnessAggregation fitnessAggregation = MeanFitness;
+	int currentCase = 0;
+	std::vector<float> caseFitness;
+
+	/*
+	The next generation is bred into a second population which is then swapped with the
+	current one, so after the first generation breeding reuses the same memory and allocates
+	nothing. The orders used in breeding are kept for the same reason
+	*/
+	Population nextPopulation;
+	SelectionStrategy selectionStrategy = TruncationSelection;
+	DiversityMode diversityMode = ExactDiversity;
+	DiversityMeter diversityMeter;
+	std::vector<RankedAgent> rankedAgents;
+	std::vector<int> ranking;
+	std::vector<int> parents;
+	std::vector<int> childParents;
+
+	// Sensor inputs are gathered column major (one row per input) for batched evaluation
+	NetworkKernel networkKernel = bestNetworkKernel();
+	bool validateNetwork = false;
+	std::vector<float> networkInputs;
+	std::vector<char> networkDecisions;
+	long long networkMismatches = 0;
+	bool fusedStep = true;
+	GeneticsKernel geneticsKernel = bestGeneticsKernel();
+
+	// Steady state mode keeps the fittest evaluations seen so far to breed replacements from
+	std::vector<float> elitePoolGenomes;
+	std::vector<float> elitePoolFitness;
+	const int tournamentSize = 3;
+	long long numberEvaluations = 0;
+
+	// The fittest agent seen so far, kept so it survives in snapshots
+	float bestFitness = 0;
+	std::vector<float> bestGenome;
+
+	/*
+	The telemetry of the last generation to finish, and the live agents of the one running, are
+	only recorded when telemetry is on. The buffers are swapped and reused from one generation to
+	the next so recording allocates nothing once they have grown
+	*/
+	bool recordingTelemetry = false;
+	GenerationTelemetry telemetry;
+	std::vector<int> liveAgents;
+	std::vector<float> telemetryFitness;
+	int generationTicks = 0;
+
+	// Agents are stepped in parallel in chunks which record their results separately
+	ThreadPool threadPool;
+	const int agentsPerChunk = 256;
+	std::vector<int> chunkFailures;
+	std::vector<char> chunkCheckPointsReached;
+	std::vector<int> chunkNetworkMismatches;
+};
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "Snapshot.h"
+
+static const char snapshotMagic[8] = { 'G', 'A', 'S', 'N', 'A', 'P', '\0', '\0' };
+
+SnapshotWriter::SnapshotWriter()
+{
+}
+
+// Finishes writing the last snapshot before stopping the writer thread
+SnapshotWriter::~SnapshotWriter()
+{
+	if (!writer.joinable())
+	{
+		return;
+	}
+	wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	workAvailable.notify_all();
+	writer.join();
+}
+
+// Starts a new snapshot of a number of simulations of agents with the given network
+void SnapshotWriter::begin(int numberSimulations, const std::vector<int> &networkArchitecture, int numberWeights, int genomeStride)
+{
+	buffer.clear();
+	SnapshotHeader header = {};
+	std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+	header.version = snapshotVersion;
+	header.numberSimulations = numberSimulations;
+	header.numberLayers = networkArchitecture.size();
+	header.numberWeights = numberWeights;
+	header.genomeStride = genomeStride;
+	write(&header, sizeof(header));
+	for (int layer : networkArchitecture)
+	{
+		int32_t layerSize = layer;
+		write(&layerSize, sizeof(layerSize));
+	}
+}
+
+void SnapshotWriter::write(const void *values, size_t bytes)
+{
+	buffer.insert(buffer.end(), (const char*)values, (const char*)values + bytes);
+}
+
+// Pads the snapshot with zeros to a multiple of the given number of bytes
+void SnapshotWriter::align(size_t boundary)
+{
+	buffer.resize((buffer.size() + boundary - 1) / boundary * boundary, 0);
+}
+
+/*
+Hands the snapshot built since begin to the writer thread to be written to the given path,
+first waiting for the last snapshot to be written. The thread is started by the first save
+*/
+void SnapshotWriter::save(std::string path)
+{
+	if (!writer.joinable())
+	{
+		writer = std::thread(&SnapshotWriter::writerLoop, this);
+	}
+	std::unique_lock<std::mutex> lock(mutex);
+	workFinished.wait(lock, [this] { return !writing; });
+	std::swap(buffer, writingBuffer);
+	writingPath = path;
+	writing = true;
+	lock.unlock();
+	workAvailable.notify_all();
+}
+
+// Waits for the last snapshot to be written, returning whether every snapshot so far has been
+bool SnapshotWriter::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	workFinished.wait(lock, [this] { return !writing; });
+	return !failed;
+}
+
+// Writes each snapshot to a temporary file and then moves it over the old snapshot
+void SnapshotWriter::writerLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		workAvailable.wait(lock, [this] { return stopping || writing; });
+		if (!writing)
+		{
+			return;
+		}
+		std::string path = writingPath;
+		lock.unlock();
+		std::string temporaryPath = path + ".tmp";
+		bool written;
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			file.write(writingBuffer.data(), writingBuffer.size());
+			file.flush();
+			written = file.good();
+		}
+#if !MAPPED_FILES
+		// Elsewhere a file can't be renamed over another
+		std::remove(path.c_str());
+#endif
+		written = written && std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+		lock.lock();
+		failed = failed || !written;
+		writing = false;
+		workFinished.notify_all();
+	}
+}
+
+SnapshotReader::SnapshotReader()
+{
+}
+
+SnapshotReader::~SnapshotReader()
+{
+}
+
+// Opens a snapshot and checks its header, returning false (see getError) if it can't be read
+bool SnapshotReader::open(std::string path)
+{
+	architecture.clear();
+	offset = 0;
+	if (!file.open(path))
+	{
+		data = nullptr;
+		size = 0;
+		error = "Couldn't open " + path;
+		return false;
+	}
+	data = file.getData();
+	size = file.getSize();
+	if (!read(&header, sizeof(header)) || std::memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) != 0)
+	{
+		error = path + " isn't a snapshot";
+		return false;
+	}
+	if (header.version != snapshotVersion)
+	{
+		error = path + " is a snapshot of version " + std::to_string(header.version) + " but only version "
+			+ std::to_string(snapshotVersion) + " can be read";
+		return false;
+	}
+	for (uint32_t layer = 0; layer < header.numberLayers; layer++)
+	{
+		int32_t layerSize;
+		if (!read(&layerSize, sizeof(layerSize)))
+		{
+			return false;
+		}
+		architecture.push_back(layerSize);
+	}
+	return true;
+}
+
+// Getter
+const SnapshotHeader &SnapshotReader::getHeader() const
+{
+	return header;
+}
+
+// Getter
+const std::vector<int> &SnapshotReader::getArchitecture() const
+{
+	return architecture;
+}
+
+// Getter
+const std::string &SnapshotReader::getError() const
+{
+	return error;
+}
+
+// Records why the snapshot can't be used, for callers which find a problem with its contents
+bool SnapshotReader::fail(std::string reason)
+{
+	error = reason;
+	return false;
+}
+
+// Copies the next bytes of the snapshot, failing if the snapshot ends first
+bool SnapshotReader::read(void *values, size_t bytes)
+{
+	if (bytes > size - offset)
+	{
+		error = "The snapshot ends early";
+		return false;
+	}
+	std::memcpy(values, data + offset, bytes);
+	offset += bytes;
+	return true;
+}
+
+// Skips the padding up to the given boundary
+bool SnapshotReader::align(size_t boundary)
+{
+	size_t aligned = (offset + boundary - 1) / boundary * boundary;
+	if (aligned > size)
+	{
+		return false;
+	}
+	offset = aligned;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MappedFile.h"
+
+const uint32_t snapshotVersion = 1;
+
+/*
+The start of a snapshot file. It is followed by the network architecture (one int32 per
+layer) and then a record for each simulation in it (see Simulation::saveSnapshot). Numbers are
+stored as the machine stores them, so snapshots are only read on the kind of machine that
+wrote them
+*/
+struct SnapshotHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t numberSimulations;
+	uint32_t numberLayers;
+	uint32_t numberWeights;
+	uint32_t genomeStride;
+	uint32_t reserved;
+};
+
+/*
+Builds a snapshot in memory and writes it to disk on a background thread, so a run only
+stops for as long as it takes to copy its state. A snapshot is written to a temporary file
+which then replaces the old one, so a crash mid write never leaves a broken snapshot behind.
+Arrays are stored as a 64 bit count followed by the values starting on a 64 byte boundary,
+so a mapped snapshot can be read in place. Only one snapshot is written at a time: saving
+another waits for the last to finish. The two buffers are reused, so once they have grown
+snapshots allocate nothing
+*/
+class SnapshotWriter
+{
+public:
+	SnapshotWriter();
+	~SnapshotWriter();
+
+	void begin(int, const std::vector<int>&, int, int);
+
+	void write(const void*, size_t);
+
+	// Writes an array of count values
+	template<typename T>
+	void writeArray(const T *values, size_t count)
+	{
+		uint64_t numberValues = count;
+		align(8);
+		write(&numberValues, sizeof(numberValues));
+		align(64);
+		write(values, count * sizeof(T));
+	}
+
+	template<typename T>
+	void writeArray(const std::vector<T> &values)
+	{
+		writeArray(values.data(), values.size());
+	}
+
+	void save(std::string);
+
+	bool wait();
+
+private:
+	void align(size_t);
+
+	void writerLoop();
+
+	std::vector<char> buffer;
+	std::vector<char> writingBuffer;
+	std::string writingPath;
+	bool writing = false;
+	bool failed = false;
+	bool stopping = false;
+	std::mutex mutex;
+	std::condition_variable workAvailable;
+	std::condition_variable workFinished;
+	std::thread writer;
+};
+
+/*
+Reads a snapshot mapped into memory, checking every read stays inside the file so a
+truncated or corrupt snapshot is reported rather than read past
+*/
+class SnapshotReader
+{
+public:
+	SnapshotReader();
+	~SnapshotReader();
+
+	bool open(std::string);
+
+	const SnapshotHeader &getHeader() const;
+
+	const std::vector<int> &getArchitecture() const;
+
+	const std::string &getError() const;
+
+	bool fail(std::string);
+
+	bool read(void*, size_t);
+
+	// Points at an array of values in place, giving its length in count
+	template<typename T>
+	const T *mapArray(size_t &count)
+	{
+		uint64_t numberValues;
+		if (!align(8) || !read(&numberValues, sizeof(numberValues)) || !align(64) || numberValues > (size - offset) / sizeof(T))
+		{
+			error = "The snapshot ends part way through an array";
+			return nullptr;
+		}
+		const T *values = (const T*)(data + offset);
+		count = numberValues;
+		offset += numberValues * sizeof(T);
+		return values;
+	}
+
+	// Copies an array which must be of the expected length
+	template<typename T>
+	bool readArray(T *values, size_t expectedCount)
+	{
+		size_t count;
+		const T *mapped = mapArray<T>(count);
+		if (!mapped)
+		{
+			return false;
+		}
+		if (count != expectedCount)
+		{
+			error = "An array in the snapshot has the wrong length";
+			return false;
+		}
+		std::copy(mapped, mapped + count, values);
+		return true;
+	}
+
+	// Copies an array of any length
+	template<typename T>
+	bool readArray(std::vector<T> &values)
+	{
+		size_t count;
+		const T *mapped = mapArray<T>(count);
+		if (!mapped)
+		{
+			return false;
+		}
+		values.assign(mapped, mapped + count);
+		return true;
+	}
+
+private:
+	bool align(size_t);
+
+	MappedFile file;
+	const char *data = nullptr;
+	size_t size = 0;
+	size_t offset = 0;
+	SnapshotHeader header;
+	std::vector<int> architecture;
+	std::string error;
+};
\ No newline at end of file
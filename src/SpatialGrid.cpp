@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include "SpatialGrid.h"
+
+SpatialGrid::SpatialGrid()
+{
+}
+
+/*
+Builds the grid over the segments. A cell size of 0 or less puts every segment in a single
+cell. Segments are added to every cell their bounding box (grown by a small margin to
+allow for rounding) overlaps
+*/
+SpatialGrid::SpatialGrid(std::vector<Segment> segments, float cellSize, IntersectionKernel kernel)
+	: kernel(kernel), numberSegments(segments.size())
+{
+	float minX = std::numeric_limits<float>::max();
+	float minY = std::numeric_limits<float>::max();
+	float maxX = std::numeric_limits<float>::lowest();
+	float maxY = std::numeric_limits<float>::lowest();
+	for (const Segment &segment : segments)
+	{
+		minX = std::min({ minX, segment.start.x, segment.end.x });
+		minY = std::min({ minY, segment.start.y, segment.end.y });
+		maxX = std::max({ maxX, segment.start.x, segment.end.x });
+		maxY = std::max({ maxY, segment.start.y, segment.end.y });
+	}
+	if (segments.empty())
+	{
+		minX = minY = maxX = maxY = 0;
+	}
+	float extent = std::max({ maxX - minX, maxY - minY, 1.0f });
+	margin = extent * 1e-5f;
+	origin = { minX - margin, minY - margin };
+	extent += 2 * margin;
+	if (cellSize <= 0)
+	{
+		cellSize = extent;
+	}
+	this->cellSize = std::max(cellSize, extent / maxCellsPerSide);
+	numberColumns = std::max(1, (int)std::ceil((maxX - origin.x + margin) / this->cellSize));
+	numberRows = std::max(1, (int)std::ceil((maxY - origin.y + margin) / this->cellSize));
+
+	// Counts the segments in each cell and then fills them in (compressed sparse row layout)
+	builtCellStart.assign(numberColumns * numberRows + 1, 0);
+	std::vector<int> cellSegmentIndices;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		if (pass == 1)
+		{
+			for (int cell = 0; cell < numberColumns * numberRows; cell++)
+			{
+				builtCellStart[cell + 1] += builtCellStart[cell];
+			}
+			cellSegmentIndices.resize(builtCellStart.back());
+		}
+		std::vector<int> filled(numberColumns * numberRows, 0);
+		for (int index = 0; index < (int)segments.size(); index++)
+		{
+			const Segment &segment = segments[index];
+			int firstColumn, firstRow, lastColumn, lastRow;
+			getCell({ std::min(segment.start.x, segment.end.x) - margin, std::min(segment.start.y, segment.end.y) - margin }, firstColumn, firstRow);
+			getCell({ std::max(segment.start.x, segment.end.x) + margin, std::max(segment.start.y, segment.end.y) + margin }, lastColumn, lastRow);
+			for (int row = std::max(firstRow, 0); row <= std::min(lastRow, numberRows - 1); row++)
+			{
+				for (int column = std::max(firstColumn, 0); column <= std::min(lastColumn, numberColumns - 1); column++)
+				{
+					int cell = row * numberColumns + column;
+					if (pass == 0)
+					{
+						builtCellStart[cell + 1]++;
+					}
+					else
+					{
+						cellSegmentIndices[builtCellStart[cell] + filled[cell]++] = index;
+					}
+				}
+			}
+		}
+	}
+	// Each cell's segments are copied out contiguously so they can be loaded as vectors
+	for (int index : cellSegmentIndices)
+	{
+		cellSegments.append(segments[index]);
+	}
+	cellStart = builtCellStart.data();
+}
+
+/*
+A view of a grid built earlier with the given layout. The cellStart array has an entry for
+every cell and one more, and the owner keeps it and the cell segments' arrays alive
+*/
+SpatialGrid::SpatialGrid(SpatialGridLayout layout, std::shared_ptr<const void> owner, const int *cellStart, SegmentArrays cellSegments, IntersectionKernel kernel)
+	: kernel(kernel), numberSegments(layout.numberSegments), origin(layout.origin), cellSize(layout.cellSize), margin(layout.margin),
+	numberColumns(layout.numberColumns), numberRows(layout.numberRows), owner(owner), cellStart(cellStart), cellSegments(std::move(cellSegments))
+{
+}
+
+/*
+Picks a cell size giving roughly two segments per cell over the area the segments cover,
+which keeps both the number of cells a ray crosses and the segments per cell small
+*/
+float SpatialGrid::chooseCellSize(const std::vector<Segment> &segments)
+{
+	if (segments.empty())
+	{
+		return 0;
+	}
+	float minX = std::numeric_limits<float>::max();
+	float minY = std::numeric_limits<float>::max();
+	float maxX = std::numeric_limits<float>::lowest();
+	float maxY = std::numeric_limits<float>::lowest();
+	for (const Segment &segment : segments)
+	{
+		minX = std::min({ minX, segment.start.x, segment.end.x });
+		minY = std::min({ minY, segment.start.y, segment.end.y });
+		maxX = std::max({ maxX, segment.start.x, segment.end.x });
+		maxY = std::max({ maxY, segment.start.y, segment.end.y });
+	}
+	float area = std::max(maxX - minX, 1.0f) * std::max(maxY - minY, 1.0f);
+	return std::sqrt(area / std::max(segments.size() / 2.0f, 1.0f));
+}
+
+// The column and row of the cell containing a point, which may be outside the grid
+void SpatialGrid::getCell(Vector2 point, int &column, int &row) const
+{
+	column = (int)std::floor((point.x - origin.x) / cellSize);
+	row = (int)std::floor((point.y - origin.y) / cellSize);
+}
+
+/*
+Finds the nearest wall along a ray from rayStart in the unit length rayDirection. Returns
+the distance to it (the proportion mu along the ray from checkIntersection) or infinity if
+no wall is hit within maxDistance, so the result is the same however the walls are divided
+into cells. Cells are visited in order along the ray so the search
+stops as soon as the next cell is further away than the nearest wall found so far
+*/
+float SpatialGrid::castRay(Vector2 rayStart, Vector2 rayDirection, float maxDistance) const
+{
+	float nearest = std::numeric_limits<float>::infinity();
+	Vector2 rayEnd = rayStart + rayDirection;
+	int column, row;
+	getCell(rayStart, column, row);
+	int stepColumn = rayDirection.x > 0 ? 1 : -1;
+	int stepRow = rayDirection.y > 0 ? 1 : -1;
+	float infinity = std::numeric_limits<float>::infinity();
+	// Distance along the ray to the next column and row boundaries and between boundaries
+	float nextColumnX = origin.x + (column + (stepColumn > 0 ? 1 : 0)) * cellSize;
+	float nextRowY = origin.y + (row + (stepRow > 0 ? 1 : 0)) * cellSize;
+	float distanceToColumn = rayDirection.x != 0 ? (nextColumnX - rayStart.x) / rayDirection.x : infinity;
+	float distanceToRow = rayDirection.y != 0 ? (nextRowY - rayStart.y) / rayDirection.y : infinity;
+	float columnDelta = rayDirection.x != 0 ? cellSize / std::fabs(rayDirection.x) : infinity;
+	float rowDelta = rayDirection.y != 0 ? cellSize / std::fabs(rayDirection.y) : infinity;
+	while (true)
+	{
+		if (column >= 0 && column < numberColumns && row >= 0 && row < numberRows)
+		{
+			int cell = row * numberColumns + column;
+			nearest = nearestIntersection(kernel, cellSegments, cellStart[cell], cellStart[cell + 1], rayStart, rayEnd, nearest, maxDistance);
+		}
+		// Distance at which the ray leaves the current cell
+		float exitDistance = std::min(distanceToColumn, distanceToRow);
+		if (exitDistance > std::min(nearest, maxDistance) + margin)
+		{
+			break;
+		}
+		if (distanceToColumn < distanceToRow)
+		{
+			column += stepColumn;
+			distanceToColumn += columnDelta;
+		}
+		else
+		{
+			row += stepRow;
+			distanceToRow += rowDelta;
+		}
+	}
+	return nearest;
+}
+
+/*
+Whether the segment from start to end intersects any wall, with the intersection inside
+both the segment and the wall. Only the cells covered by the segment's bounding box are
+searched
+*/
+bool SpatialGrid::intersectsSegment(Vector2 start, Vector2 end) const
+{
+	int firstColumn, firstRow, lastColumn, lastRow;
+	getCell({ std::min(start.x, end.x) - margin, std::min(start.y, end.y) - margin }, firstColumn, firstRow);
+	getCell({ std::max(start.x, end.x) + margin, std::max(start.y, end.y) + margin }, lastColumn, lastRow);
+	for (int row = std::max(firstRow, 0); row <= std::min(lastRow, numberRows - 1); row++)
+	{
+		for (int column = std::max(firstColumn, 0); column <= std::min(lastColumn, numberColumns - 1); column++)
+		{
+			int cell = row * numberColumns + column;
+			if (anyIntersection(kernel, cellSegments, cellStart[cell], cellStart[cell + 1], start, end))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/*
+Whether any of the segments from start to each of the count ends intersects a wall. The
+cells covered by all of the segments are searched once, which is cheaper than a search per
+segment when they share a start as the edges of the agents' bodies do
+*/
+bool SpatialGrid::intersectsSegments(Vector2 start, const Vector2 *ends, int count) const
+{
+	Vector2 low = start;
+	Vector2 high = start;
+	for (int i = 0; i < count; i++)
+	{
+		low = { std::min(low.x, ends[i].x), std::min(low.y, ends[i].y) };
+		high = { std::max(high.x, ends[i].x), std::max(high.y, ends[i].y) };
+	}
+	int firstColumn, firstRow, lastColumn, lastRow;
+	getCell({ low.x - margin, low.y - margin }, firstColumn, firstRow);
+	getCell({ high.x + margin, high.y + margin }, lastColumn, lastRow);
+	for (int row = std::max(firstRow, 0); row <= std::min(lastRow, numberRows - 1); row++)
+	{
+		for (int column = std::max(firstColumn, 0); column <= std::min(lastColumn, numberColumns - 1); column++)
+		{
+			int cell = row * numberColumns + column;
+			for (int i = 0; i < count; i++)
+			{
+				if (anyIntersection(kernel, cellSegments, cellStart[cell], cellStart[cell + 1], start, ends[i]))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// Getter
+int SpatialGrid::getNumberSegments() const
+{
+	return numberSegments;
+}
+
+// Getter
+int SpatialGrid::getNumberCells() const
+{
+	return numberColumns * numberRows;
+}
+
+
+// Where the grid is and how it's divided, so it can be stored and viewed again later
+SpatialGridLayout SpatialGrid::getLayout() const
+{
+	return { origin, cellSize, margin, numberColumns, numberRows, numberSegments };
+}
+
+// Getter
+const int *SpatialGrid::getCellStart() const
+{
+	return cellStart;
+}
+
+// Getter
+const SegmentArrays &SpatialGrid::getCellSegments() const
+{
+	return cellSegments;
+}
\ No newline at end of file
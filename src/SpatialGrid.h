@@ -0,0 +1,70 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "Geometry.h"
+#include "Intersection.h"
+
+// Where a grid is and how it's divided into cells
+struct SpatialGridLayout
+{
+	Vector2 origin;
+	float cellSize;
+	float margin;
+	int numberColumns;
+	int numberRows;
+	int numberSegments;
+};
+
+/*
+A uniform grid over a flat array of wall segments. Each cell lists the segments whose
+bounding boxes overlap it, so a ray only needs testing against the segments in the cells it
+passes through (found with a DDA traversal) and a short segment only against those in the
+cells its bounding box covers. A grid with a single cell tests every segment, which is the
+brute force behaviour. The segments in a cell are tested together by an intersection kernel.
+A grid is either built from segments or is a view of one built earlier and stored elsewhere,
+such as in a mapped track file. Like its segment arrays, a grid can be moved but not copied
+*/
+class SpatialGrid
+{
+public:
+	// Cells per side are capped so a map with a huge extent can't exhaust memory
+	static const int maxCellsPerSide = 4096;
+
+	SpatialGrid();
+	SpatialGrid(std::vector<Segment>, float, IntersectionKernel = bestIntersectionKernel());
+	SpatialGrid(SpatialGridLayout, std::shared_ptr<const void>, const int*, SegmentArrays, IntersectionKernel = bestIntersectionKernel());
+
+	static float chooseCellSize(const std::vector<Segment>&);
+
+	float castRay(Vector2, Vector2, float) const;
+
+	bool intersectsSegment(Vector2, Vector2) const;
+
+	bool intersectsSegments(Vector2, const Vector2*, int) const;
+
+	int getNumberSegments() const;
+
+	int getNumberCells() const;
+
+	SpatialGridLayout getLayout() const;
+
+	const int *getCellStart() const;
+
+	const SegmentArrays &getCellSegments() const;
+
+private:
+	void getCell(Vector2, int&, int&) const;
+
+	IntersectionKernel kernel = ScalarIntersection;
+	int numberSegments = 0;
+	Vector2 origin = { 0, 0 };
+	float cellSize = 1;
+	float margin = 0;
+	int numberColumns = 0;
+	int numberRows = 0;
+	// The segments of cell i are cellSegments[cellStart[i]] to cellSegments[cellStart[i + 1] - 1]
+	std::vector<int> builtCellStart;
+	std::shared_ptr<const void> owner;
+	const int *cellStart = nullptr;
+	SegmentArrays cellSegments;
+};
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cstdarg>
+#include "Simulation.h"
+#include "Telemetry.h"
+
+TelemetryWriter::TelemetryWriter()
+{
+}
+
+// Writes any records still in the buffer before stopping the writer thread
+TelemetryWriter::~TelemetryWriter()
+{
+	close();
+}
+
+/*
+Creates the file, writing the header row of a CSV file, and starts the writer thread. The
+instrumentation added before the file is opened isn't counted towards the first generation
+*/
+bool TelemetryWriter::open(std::string path, TelemetryFormat format)
+{
+	close();
+	file = std::fopen(path.c_str(), "w");
+	if (!file)
+	{
+		return false;
+	}
+	this->format = format;
+	failed = false;
+	stopping = false;
+	lastRecordTime = std::chrono::steady_clock::now();
+	lastTotals = getInstrumentationTotals();
+	if (format == CsvTelemetry)
+	{
+		record.clear();
+		append("generation,evaluations,seconds,maxFitness,averageFitness,minFitness");
+		for (int percentile : fitnessPercentiles)
+		{
+			append(",p%dFitness", percentile);
+		}
+		append(",diversity,weightVariance,centroidDistance,ticks");
+#if INSTRUMENTATION
+		for (int timer = 0; timer < numberInstrumentationTimers; timer++)
+		{
+			const char *name = getInstrumentationTimerName((InstrumentationTimer)timer);
+			append(",%sNanoseconds,%sCalls", name, name);
+		}
+		for (int counter = 0; counter < numberInstrumentationCounters; counter++)
+		{
+			append(",%s", getInstrumentationCounterName((InstrumentationCounter)counter));
+		}
+#endif
+		append(",liveAgents\n");
+		buffer = record;
+	}
+	writer = std::thread(&TelemetryWriter::writerLoop, this);
+	workAvailable.notify_all();
+	return true;
+}
+
+// Formats text onto the end of the record being built
+void TelemetryWriter::append(const char *text, ...)
+{
+	char formatted[256];
+	va_list arguments;
+	va_start(arguments, text);
+	int length = std::vsnprintf(formatted, sizeof(formatted), text, arguments);
+	va_end(arguments);
+	record.append(formatted, std::min(length, (int)sizeof(formatted) - 1));
+}
+
+/*
+Adds a record for a generation which has just finished. In CSV the live agent counts are one
+field of counts separated by spaces
+*/
+void TelemetryWriter::write(const GenerationStatistics &statistics, const GenerationTelemetry &telemetry)
+{
+	if (!file)
+	{
+		return;
+	}
+	std::chrono::steady_clock::time_point recordTime = std::chrono::steady_clock::now();
+	std::chrono::duration<double> elapsed = recordTime - lastRecordTime;
+	lastRecordTime = recordTime;
+	InstrumentationTotals totals = getInstrumentationTotals();
+	bool csv = format == CsvTelemetry;
+	record.clear();
+	append(csv ? "%d,%lld,%.6f,%d,%d,%g" : "{\"generation\":%d,\"evaluations\":%lld,\"seconds\":%.6f,\"maxFitness\":%d,\"averageFitness\":%d,\"minFitness\":%g",
+		statistics.generation, telemetry.evaluations, elapsed.count(), statistics.maxFitness, statistics.averageFitness, telemetry.minFitness);
+	for (int i = 0; i < numberFitnessPercentiles; i++)
+	{
+		csv ? append(",%g", telemetry.percentiles[i]) : append(",\"p%dFitness\":%g", fitnessPercentiles[i], telemetry.percentiles[i]);
+	}
+	append(csv ? ",%g,%g,%g,%d" : ",\"diversity\":%g,\"weightVariance\":%g,\"centroidDistance\":%g,\"ticks\":%d",
+		statistics.diversity, statistics.weightVariance, statistics.centroidDistance, telemetry.ticks);
+#if INSTRUMENTATION
+	for (int timer = 0; timer < numberInstrumentationTimers; timer++)
+	{
+		const char *name = getInstrumentationTimerName((InstrumentationTimer)timer);
+		long long nanoseconds = totals.nanoseconds[timer] - lastTotals.nanoseconds[timer];
+		long long calls = totals.calls[timer] - lastTotals.calls[timer];
+		csv ? append(",%lld,%lld", nanoseconds, calls) : append(",\"%sNanoseconds\":%lld,\"%sCalls\":%lld", name, nanoseconds, name, calls);
+	}
+	for (int counter = 0; counter < numberInstrumentationCounters; counter++)
+	{
+		long long count = totals.counts[counter] - lastTotals.counts[counter];
+		csv ? append(",%lld", count) : append(",\"%s\":%lld", getInstrumentationCounterName((InstrumentationCounter)counter), count);
+	}
+#endif
+	lastTotals = totals;
+	append(csv ? "," : ",\"liveAgents\":[");
+	for (int i = 0; i < (int)telemetry.liveAgents.size(); i++)
+	{
+		append(i > 0 ? (csv ? " %d" : ",%d") : "%d", telemetry.liveAgents[i]);
+	}
+	append(csv ? "\n" : "]}\n");
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		buffer += record;
+	}
+	workAvailable.notify_all();
+}
+
+/*
+Waits for every record to be written and closes the file, returning whether they all were.
+Does nothing if no file is open
+*/
+bool TelemetryWriter::close()
+{
+	if (!file)
+	{
+		return true;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	workAvailable.notify_all();
+	writer.join();
+	failed |= std::fclose(file) != 0;
+	file = nullptr;
+	return !failed;
+}
+
+/*
+Takes whatever is in the buffer, swapping it with an empty one so records can be added while
+it's written, and flushes it to disk so the records can be followed while a run goes on
+*/
+void TelemetryWriter::writerLoop()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			workAvailable.wait(lock, [this] { return stopping || !buffer.empty(); });
+			if (buffer.empty())
+			{
+				return;
+			}
+			std::swap(buffer, writingBuffer);
+		}
+		bool written = std::fwrite(writingBuffer.data(), 1, writingBuffer.size(), file) == writingBuffer.size() && std::fflush(file) == 0;
+		writingBuffer.clear();
+		std::lock_guard<std::mutex> lock(mutex);
+		failed |= !written;
+	}
+}
+
+const char *getTelemetryFormatName(TelemetryFormat format)
+{
+	switch (format)
+	{
+	case CsvTelemetry:
+		return "csv";
+	case NdjsonTelemetry:
+		return "ndjson";
+	}
+	return "unknown";
+}
+
+// Looks up a format by the name getTelemetryFormatName gives it
+bool parseTelemetryFormat(std::string name, TelemetryFormat &format)
+{
+	for (TelemetryFormat candidate : { CsvTelemetry, NdjsonTelemetry })
+	{
+		if (name == getTelemetryFormatName(candidate))
+		{
+			format = candidate;
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Instrumentation.h"
+
+struct GenerationStatistics;
+
+// The number of live agents is sampled once every this many ticks of a generation
+const int liveAgentSampleTicks = 10;
+
+const int numberFitnessPercentiles = 5;
+
+// The percentiles of the fitnesses recorded for each generation
+const int fitnessPercentiles[numberFitnessPercentiles] = { 10, 25, 50, 75, 90 };
+
+/*
+What a simulation records about a generation beyond its statistics when telemetry is on: the
+spread of its fitnesses (before they're randomised for selection) and how many agents were
+still running every liveAgentSampleTicks ticks, which shows how quickly a generation dies off
+*/
+struct GenerationTelemetry
+{
+	long long evaluations = 0;
+	int ticks = 0;
+	float minFitness = 0;
+	float percentiles[numberFitnessPercentiles] = {};
+	std::vector<int> liveAgents;
+};
+
+enum TelemetryFormat
+{
+	CsvTelemetry,
+	NdjsonTelemetry
+};
+
+/*
+Writes a record for every generation of a run to a file, as a CSV row or a line of JSON. Each
+record holds the generation's statistics and telemetry, the time since the last record and,
+in instrumented builds, what each timer and counter added during the generation. Records are
+formatted into a buffer and written and flushed on a background thread, so a run never waits
+on the disk. The two buffers are reused, so once they have grown recording allocates nothing
+*/
+class TelemetryWriter
+{
+public:
+	TelemetryWriter();
+	~TelemetryWriter();
+
+	bool open(std::string, TelemetryFormat);
+
+	void write(const GenerationStatistics&, const GenerationTelemetry&);
+
+	bool close();
+
+private:
+	void append(const char*, ...);
+
+	void writerLoop();
+
+	FILE *file = nullptr;
+	TelemetryFormat format = NdjsonTelemetry;
+	std::chrono::steady_clock::time_point lastRecordTime;
+	InstrumentationTotals lastTotals;
+	// Each record is formatted on its own before being added to the buffer under the lock
+	std::string record;
+	std::string buffer;
+	std::string writingBuffer;
+	bool failed = false;
+	bool stopping = false;
+	std::mutex mutex;
+	std::condition_variable workAvailable;
+	std::thread writer;
+};
+
+const char *getTelemetryFormatName(TelemetryFormat);
+
+bool parseTelemetryFormat(std::string, TelemetryFormat&);
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+// A thread count of 0 uses one thread per hardware thread
+ThreadPool::ThreadPool(int numberThreads)
+	: numberThreads(numberThreads)
+{
+	if (this->numberThreads <= 0)
+	{
+		this->numberThreads = std::max(1, (int)std::thread::hardware_concurrency());
+	}
+	for (int i = 0; i < this->numberThreads; i++)
+	{
+		queues.push_back(std::make_unique<WorkQueue>());
+	}
+	// Queue 0 belongs to the calling thread so only the rest need a thread of their own
+	for (int i = 1; i < this->numberThreads; i++)
+	{
+		workers.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+	for (std::thread &worker : workers)
+	{
+		worker.join();
+	}
+}
+
+// Getter
+int ThreadPool::getNumberThreads()
+{
+	return numberThreads;
+}
+
+/*
+Calls function(begin, end, chunk) for every chunk of chunkSize indices in [0, count) and
+returns once all of them have finished. Chunk numbers are stable regardless of which thread
+runs a chunk so callers can write per chunk results and reduce them in a deterministic order
+*/
+void ThreadPool::parallelFor(int count, int chunkSize, const std::function<void(int, int, int)> &function)
+{
+	int numberChunks = (count + chunkSize - 1) / chunkSize;
+	if (numberThreads == 1 || numberChunks <= 1)
+	{
+		for (int chunk = 0; chunk < numberChunks; chunk++)
+		{
+			function(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize), chunk);
+		}
+		return;
+	}
+	job = &function;
+	remainingTasks = numberChunks;
+	// Deals contiguous runs of chunks to each queue so neighbouring chunks stay on one thread
+	for (int queue = 0; queue < numberThreads; queue++)
+	{
+		int firstChunk = numberChunks * queue / numberThreads;
+		int lastChunk = numberChunks * (queue + 1) / numberThreads;
+		std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+		queues[queue]->tasks.clear();
+		queues[queue]->front = 0;
+		for (int chunk = firstChunk; chunk < lastChunk; chunk++)
+		{
+			queues[queue]->tasks.push_back({ chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize), chunk });
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		jobGeneration++;
+	}
+	jobAvailable.notify_all();
+	while (runTask(0))
+	{
+	}
+	std::unique_lock<std::mutex> lock(jobMutex);
+	jobFinished.wait(lock, [this] { return remainingTasks == 0; });
+	job = nullptr;
+}
+
+// Workers sleep until a new loop is started and then run tasks until every queue is empty
+void ThreadPool::workerLoop(int index)
+{
+	int seenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobAvailable.wait(lock, [&] { return stopping || jobGeneration != seenGeneration; });
+			if (stopping)
+			{
+				return;
+			}
+			seenGeneration = jobGeneration;
+		}
+		while (runTask(index))
+		{
+		}
+	}
+}
+
+// Runs a single task from the worker's own queue or one stolen from another worker
+bool ThreadPool::runTask(int index)
+{
+	Task task;
+	bool found = false;
+	{
+		std::lock_guard<std::mutex> lock(queues[index]->mutex);
+		if ((int)queues[index]->tasks.size() > queues[index]->front)
+		{
+			task = queues[index]->tasks.back();
+			queues[index]->tasks.pop_back();
+			found = true;
+		}
+	}
+	for (int offset = 1; !found && offset < numberThreads; offset++)
+	{
+		WorkQueue &victim = *queues[(index + offset) % numberThreads];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if ((int)victim.tasks.size() > victim.front)
+		{
+			task = victim.tasks[victim.front++];
+			found = true;
+		}
+	}
+	if (!found)
+	{
+		return false;
+	}
+	(*job)(task.begin, task.end, task.chunk);
+	if (--remainingTasks == 0)
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		jobFinished.notify_all();
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Task
+{
+	int begin;
+	int end;
+	int chunk;
+};
+
+/*
+A fixed size pool of worker threads which runs data parallel loops. Each loop is cut into
+chunks which are dealt out to a queue per worker; workers take from the back of their own
+queue and steal from the front of the others' once theirs is empty so uneven chunks (such
+as ones full of failed agents) don't leave threads idle. The calling thread works as well
+*/
+class ThreadPool
+{
+public:
+	ThreadPool(int);
+	~ThreadPool();
+
+	int getNumberThreads();
+
+	void parallelFor(int, int, const std::function<void(int, int, int)>&);
+
+private:
+	/*
+	The owner takes tasks from the back and thieves from the front, which only moves on, so
+	the tasks of every loop reuse the memory of the last and no loop allocates once warm
+	*/
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::vector<Task> tasks;
+		int front = 0;
+	};
+
+	void workerLoop(int);
+
+	bool runTask(int);
+
+	int numberThreads;
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<WorkQueue>> queues;
+	const std::function<void(int, int, int)> *job = nullptr;
+	std::atomic<int> remainingTasks{ 0 };
+	std::mutex jobMutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable jobFinished;
+	int jobGeneration = 0;
+	bool stopping = false;
+};
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include <utility>
+#include "Track.h"
+#include "TrackFile.h"
+
+/*
+Compiles a map into a track. A cell size of less than 0 lets the grid of walls choose one
+from the map and 0 puts every wall in a single cell. The walls in a cell are tested with the
+given intersection kernel
+*/
+Track::Track(Map map, float cellSize, IntersectionKernel kernel)
+	: map(std::move(map))
+{
+	std::vector<Segment> wallSegments = getWallSegments(this->map);
+	walls = SpatialGrid(wallSegments, cellSize < 0 ? SpatialGrid::chooseCellSize(wallSegments) : cellSize, kernel);
+	pairCheckPoints();
+}
+
+// A track whose grid of walls has already been built from the map
+Track::Track(Map map, SpatialGrid walls)
+	: map(std::move(map)), walls(std::move(walls))
+{
+	pairCheckPoints();
+}
+
+/*
+Loads a track which can be shared from either a compiled track file, whose grid is already
+built so the cell size is ignored, or a map file which is compiled on loading. Returns null
+with the reason in error if the file can't be read or isn't valid
+*/
+std::shared_ptr<const Track> Track::load(std::string path, std::string &error, float cellSize, IntersectionKernel kernel)
+{
+	if (isTrackFile(path))
+	{
+		return readTrackFile(path, kernel, error);
+	}
+	Map map;
+	if (!loadMap(path, map, error))
+	{
+		return nullptr;
+	}
+	return std::make_shared<const Track>(std::move(map), cellSize, kernel);
+}
+
+// Pairs up the check point vertices into segments
+void Track::pairCheckPoints()
+{
+	for (int i = 0; i + 1 < (int)map.checkPoints.size(); i += 2)
+	{
+		checkPoints.push_back({ map.checkPoints[i], map.checkPoints[i + 1] });
+	}
+}
+
+// Getter
+const SpatialGrid &Track::getWalls() const
+{
+	return walls;
+}
+
+// Getter
+const std::vector<Segment> &Track::getCheckPoints() const
+{
+	return checkPoints;
+}
+
+// Getter
+Vector2 Track::getStartingPosition() const
+{
+	return map.startingPosition;
+}
+
+// Getter
+int Track::getStartingAngle() const
+{
+	return map.startingAngle;
+}
+
+// The population size given in the map file
+int Track::getNumberAgents() const
+{
+	return map.numberAgents;
+}
+
+// The map the track was compiled from, for drawing
+const Map &Track::getMap() const
+{
+	return map;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "Geometry.h"
+#include "Map.h"
+#include "SpatialGrid.h"
+
+/*
+An immutable, preprocessed map which every agent and simulation running on it shares. The
+walls are compiled into a grid of prepared segments once, so memory is proportional to the
+map rather than to the number of agents using it, and nothing about the map is copied when
+a new generation starts. A track can be compiled into a file (see TrackFile.h) which is mapped
+straight back into one without rebuilding its grid
+*/
+class Track
+{
+public:
+	Track(Map, float = -1, IntersectionKernel = bestIntersectionKernel());
+	Track(Map, SpatialGrid);
+
+	static std::shared_ptr<const Track> load(std::string, std::string&, float = -1, IntersectionKernel = bestIntersectionKernel());
+
+	const SpatialGrid &getWalls() const;
+
+	const std::vector<Segment> &getCheckPoints() const;
+
+	Vector2 getStartingPosition() const;
+
+	int getStartingAngle() const;
+
+	int getNumberAgents() const;
+
+	const Map &getMap() const;
+
+private:
+	void pairCheckPoints();
+
+	Map map;
+	SpatialGrid walls;
+	std::vector<Segment> checkPoints;
+};
\ No newline at end of file
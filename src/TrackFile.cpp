@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include "MappedFile.h"
+#include "TrackFile.h"
+
+static const char trackFileMagic[8] = { 'G', 'A', 'T', 'R', 'A', 'C', 'K', '\0' };
+
+static_assert(sizeof(Vector2) == 2 * sizeof(float), "Vertices are stored as pairs of floats");
+
+// Pads the file being built with zeros to a multiple of the given number of bytes
+static void align(std::vector<char> &buffer, size_t boundary)
+{
+	buffer.resize((buffer.size() + boundary - 1) / boundary * boundary, 0);
+}
+
+// Appends an array of count values, laid out as SnapshotWriter lays them out
+template<typename T>
+static void writeArray(std::vector<char> &buffer, const T *values, size_t count)
+{
+	uint64_t numberValues = count;
+	align(buffer, 8);
+	buffer.insert(buffer.end(), (const char*)&numberValues, (const char*)(&numberValues + 1));
+	align(buffer, 64);
+	buffer.insert(buffer.end(), (const char*)values, (const char*)(values + count));
+}
+
+// Points at the next array of a mapped track file in place, failing if it runs past the end
+template<typename T>
+static const T *mapArray(const MappedFile &file, size_t &offset, size_t &count)
+{
+	size_t countOffset = (offset + 7) / 8 * 8;
+	if (countOffset + sizeof(uint64_t) > file.getSize())
+	{
+		return nullptr;
+	}
+	uint64_t numberValues;
+	std::memcpy(&numberValues, file.getData() + countOffset, sizeof(numberValues));
+	size_t valuesOffset = (countOffset + sizeof(uint64_t) + 63) / 64 * 64;
+	if (valuesOffset > file.getSize() || numberValues > (file.getSize() - valuesOffset) / sizeof(T))
+	{
+		return nullptr;
+	}
+	count = numberValues;
+	offset = valuesOffset + numberValues * sizeof(T);
+	return (const T*)(file.getData() + valuesOffset);
+}
+
+// Whether the array of count starts begins at 0, never goes down and ends at last
+static bool areStartsValid(const int32_t *starts, size_t count, int64_t last)
+{
+	if (count == 0 || starts[0] != 0 || starts[count - 1] != last)
+	{
+		return false;
+	}
+	for (size_t i = 1; i < count; i++)
+	{
+		if (starts[i] < starts[i - 1])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Whether a file starts as a compiled track does rather than being a text map
+bool isTrackFile(std::string path)
+{
+	char magic[sizeof(trackFileMagic)] = {};
+	std::ifstream file(path, std::ios::binary);
+	file.read(magic, sizeof(magic));
+	return file && std::memcmp(magic, trackFileMagic, sizeof(trackFileMagic)) == 0;
+}
+
+/*
+Compiles a track into a file which readTrackFile can map straight back into a track, with its
+grid of walls already built. Returns false with the reason in error if it can't be written
+*/
+bool writeTrackFile(std::string path, const Track &track, std::string &error)
+{
+	const Map &map = track.getMap();
+	const SpatialGrid &walls = track.getWalls();
+	SpatialGridLayout layout = walls.getLayout();
+	TrackFileHeader header = {};
+	std::memcpy(header.magic, trackFileMagic, sizeof(trackFileMagic));
+	header.version = trackFileVersion;
+	header.startingAngle = map.startingAngle;
+	header.numberAgents = map.numberAgents;
+	header.startingX = map.startingPosition.x;
+	header.startingY = map.startingPosition.y;
+	header.originX = layout.origin.x;
+	header.originY = layout.origin.y;
+	header.cellSize = layout.cellSize;
+	header.margin = layout.margin;
+	header.numberColumns = layout.numberColumns;
+	header.numberRows = layout.numberRows;
+	header.numberSegments = layout.numberSegments;
+
+	std::vector<int32_t> elementStart = { 0 };
+	std::vector<Vector2> vertices;
+	for (const std::vector<Vector2> &mapElement : map.mapElements)
+	{
+		vertices.insert(vertices.end(), mapElement.begin(), mapElement.end());
+		elementStart.push_back(vertices.size());
+	}
+	const SegmentArrays &cellSegments = walls.getCellSegments();
+	size_t paddedSize = cellSegments.size() + SegmentArrays::padding;
+	std::vector<char> buffer((const char*)&header, (const char*)(&header + 1));
+	writeArray(buffer, elementStart.data(), elementStart.size());
+	writeArray(buffer, vertices.data(), vertices.size());
+	writeArray(buffer, map.checkPoints.data(), map.checkPoints.size());
+	writeArray(buffer, walls.getCellStart(), walls.getNumberCells() + 1);
+	writeArray(buffer, cellSegments.getStartX(), paddedSize);
+	writeArray(buffer, cellSegments.getStartY(), paddedSize);
+	writeArray(buffer, cellSegments.getDeltaX(), paddedSize);
+	writeArray(buffer, cellSegments.getDeltaY(), paddedSize);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(buffer.data(), buffer.size());
+	file.flush();
+	if (!file)
+	{
+		error = "Couldn't write " + path;
+		return false;
+	}
+	return true;
+}
+
+/*
+Maps a compiled track file into memory and makes a track whose grid of walls points into
+it, so nothing but the map elements (which are only used for drawing) is copied however
+large the track is. The layout of the file is checked, so a file which is truncated or whose
+counts and grid don't agree is reported in error rather than read past. The walls are
+tested with the given intersection kernel
+*/
+std::shared_ptr<const Track> readTrackFile(std::string path, IntersectionKernel kernel, std::string &error)
+{
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+	if (!file->open(path))
+	{
+		error = "Couldn't open " + path;
+		return nullptr;
+	}
+	TrackFileHeader header;
+	if (file->getSize() < sizeof(header) || std::memcmp(file->getData(), trackFileMagic, sizeof(trackFileMagic)) != 0)
+	{
+		error = path + " isn't a compiled track";
+		return nullptr;
+	}
+	std::memcpy(&header, file->getData(), sizeof(header));
+	if (header.version != trackFileVersion)
+	{
+		error = path + " is a compiled track of version " + std::to_string(header.version) + " but only version "
+			+ std::to_string(trackFileVersion) + " can be read";
+		return nullptr;
+	}
+	error = path + " is corrupt: ";
+	if (header.numberAgents < minNumberAgents || header.numberSegments < 0 || !std::isfinite(header.startingX) || !std::isfinite(header.startingY))
+	{
+		error += "its starting pose or number of agents is invalid";
+		return nullptr;
+	}
+	if (header.numberColumns < 1 || header.numberColumns > SpatialGrid::maxCellsPerSide || header.numberRows < 1
+		|| header.numberRows > SpatialGrid::maxCellsPerSide || !(header.cellSize > 0) || !(header.margin >= 0)
+		|| !std::isfinite(header.cellSize) || !std::isfinite(header.margin) || !std::isfinite(header.originX) || !std::isfinite(header.originY))
+	{
+		error += "its grid is invalid";
+		return nullptr;
+	}
+
+	size_t offset = sizeof(header);
+	size_t numberElementStarts, numberVertices, numberCheckPoints, numberCellStarts;
+	size_t startXSize, startYSize, deltaXSize, deltaYSize;
+	const int32_t *elementStart = mapArray<int32_t>(*file, offset, numberElementStarts);
+	const Vector2 *vertices = elementStart ? mapArray<Vector2>(*file, offset, numberVertices) : nullptr;
+	const Vector2 *checkPoints = vertices ? mapArray<Vector2>(*file, offset, numberCheckPoints) : nullptr;
+	const int32_t *cellStart = checkPoints ? mapArray<int32_t>(*file, offset, numberCellStarts) : nullptr;
+	const float *startX = cellStart ? mapArray<float>(*file, offset, startXSize) : nullptr;
+	const float *startY = startX ? mapArray<float>(*file, offset, startYSize) : nullptr;
+	const float *deltaX = startY ? mapArray<float>(*file, offset, deltaXSize) : nullptr;
+	const float *deltaY = deltaX ? mapArray<float>(*file, offset, deltaYSize) : nullptr;
+	if (!deltaY)
+	{
+		error += "it ends part way through an array";
+		return nullptr;
+	}
+	if (!areStartsValid(elementStart, numberElementStarts, numberVertices) || numberCheckPoints % 2 != 0)
+	{
+		error += "its map elements or check points don't add up";
+		return nullptr;
+	}
+	int64_t numberSegments = 0;
+	for (size_t element = 0; element + 1 < numberElementStarts; element++)
+	{
+		numberSegments += std::max(elementStart[element + 1] - elementStart[element] - 1, 0);
+	}
+	size_t numberCells = (size_t)header.numberColumns * header.numberRows;
+	if (numberSegments != header.numberSegments || startXSize < (size_t)SegmentArrays::padding || startXSize > (size_t)INT32_MAX
+		|| startYSize != startXSize || deltaXSize != startXSize || deltaYSize != startXSize || numberCellStarts != numberCells + 1
+		|| !areStartsValid(cellStart, numberCellStarts, startXSize - SegmentArrays::padding))
+	{
+		error += "its grid doesn't match its walls";
+		return nullptr;
+	}
+	error.clear();
+
+	Map map;
+	map.startingPosition = { header.startingX, header.startingY };
+	map.startingAngle = header.startingAngle;
+	map.numberAgents = header.numberAgents;
+	map.mapElements.resize(numberElementStarts - 1);
+	for (size_t element = 0; element + 1 < numberElementStarts; element++)
+	{
+		map.mapElements[element].assign(vertices + elementStart[element], vertices + elementStart[element + 1]);
+	}
+	map.checkPoints.assign(checkPoints, checkPoints + numberCheckPoints);
+	SpatialGridLayout layout = { { header.originX, header.originY }, header.cellSize, header.margin, header.numberColumns,
+		header.numberRows, header.numberSegments };
+	SegmentArrays cellSegments(file, startX, startY, deltaX, deltaY, startXSize - SegmentArrays::padding);
+	SpatialGrid walls(layout, file, cellStart, std::move(cellSegments), kernel);
+	return std::make_shared<const Track>(std::move(map), std::move(walls));
+}
\ No newline at end of file
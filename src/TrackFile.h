@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "Track.h"
+
+const uint32_t trackFileVersion = 1;
+
+/*
+The start of a compiled track file. It is followed by arrays stored as they are in a track,
+so the file can be mapped into memory and used in place: the start of each map element's
+vertices (with one more entry for the end of the last), the vertices, the check point
+vertices, the start of each cell's walls in the grid (again with one more entry) and then
+the start x and y and delta x and y of the walls in every cell, padded as SegmentArrays are.
+Arrays are stored as in snapshots, as a 64 bit count followed by the values starting on a 64
+byte boundary, and numbers are stored as the machine stores them
+*/
+struct TrackFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	int32_t startingAngle;
+	int32_t numberAgents;
+	float startingX;
+	float startingY;
+	float originX;
+	float originY;
+	float cellSize;
+	float margin;
+	int32_t numberColumns;
+	int32_t numberRows;
+	int32_t numberSegments;
+};
+
+bool isTrackFile(std::string);
+
+bool writeTrackFile(std::string, const Track&, std::string&);
+
+std::shared_ptr<const Track> readTrackFile(std::string, IntersectionKernel, std::string&);
\ No newline at end of file
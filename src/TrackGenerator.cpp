@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Random.h"
+#include "TrackGenerator.h"
+
+static const double pi = 3.14159265358979;
+// The number of sine waves which wind the corridor
+static const int numberHarmonics = 8;
+// The length walls are aimed at, so a track's size grows with its number of walls
+static const float segmentLength = 10;
+// How far the centre line's radius can move from the mean, so the corridor never crosses itself
+static const float maxDeviation = 0.4f;
+
+/*
+The centre line of the corridor in polar form, r(theta) = R(1 + f(theta)) with f a sum of
+sine waves. Each wave k has an amplitude and phase and goes round k times per lap
+*/
+struct CentreLine
+{
+	double radius;
+	double amplitudes[numberHarmonics];
+	double phases[numberHarmonics];
+
+	// The point at theta and the unit normal pointing away from the middle of the track
+	void evaluate(double theta, Vector2 centre, Vector2 &point, Vector2 &normal) const
+	{
+		double f = 0;
+		double slope = 0;
+		for (int harmonic = 0; harmonic < numberHarmonics; harmonic++)
+		{
+			int k = harmonic + 2;
+			f += amplitudes[harmonic] * std::sin(k * theta + phases[harmonic]);
+			slope += amplitudes[harmonic] * k * std::cos(k * theta + phases[harmonic]);
+		}
+		double r = radius * (1 + f);
+		double dr = radius * slope;
+		double tangentX = dr * std::cos(theta) - r * std::sin(theta);
+		double tangentY = dr * std::sin(theta) + r * std::cos(theta);
+		double length = std::sqrt(tangentX * tangentX + tangentY * tangentY);
+		point = { (float)(centre.x + r * std::cos(theta)), (float)(centre.y + r * std::sin(theta)) };
+		normal = { (float)(tangentY / length), (float)(-tangentX / length) };
+	}
+};
+
+/*
+Generates a closed loop corridor from a seed, so the same options always give the same
+track. The centre line is star shaped (its radius is within 40% of the mean all the way
+round) so it can't cross itself, and the waves are scaled so its radius of curvature never
+drops below the corridor's width, so neither wall folds over. The mean radius is chosen so
+walls are about 10 long, but is never less than the waves need to fit, so tracks with few
+walls have longer ones. The agents start on the centre line facing along it and the check
+points cross the corridor evenly spaced round the lap
+*/
+Map generateTrack(const TrackGeneratorOptions &options)
+{
+	Random random(options.seed);
+	int segmentsPerWall = std::max(options.numberSegments / 2, 8);
+	double width = std::max(options.corridorWidth, 1.0f);
+	double curvature = std::min(std::max(options.curvature, 0.0f), 1.0f);
+
+	/*
+	With |f| <= 0.4, |f'| <= F1 and |f''| <= F2 the curvature of the centre line is at most
+	(1.4^2 + 2F1^2 + 1.4F2) / (0.6^3 R), so the waves are scaled by the largest s which keeps
+	that below 1 / width, where F1 and F2 are s times the sums for the unscaled waves
+	*/
+	CentreLine centreLine;
+	double sum = 0, sum1 = 0, sum2 = 0;
+	for (int harmonic = 0; harmonic < numberHarmonics; harmonic++)
+	{
+		int k = harmonic + 2;
+		centreLine.amplitudes[harmonic] = (0.5 + 0.5 * random.nextFloat()) / (k * k);
+		centreLine.phases[harmonic] = 2 * pi * random.nextFloat();
+		sum += centreLine.amplitudes[harmonic];
+		sum1 += centreLine.amplitudes[harmonic] * k;
+		sum2 += centreLine.amplitudes[harmonic] * k * k;
+	}
+	double minRadius = 2 * width * (1 + maxDeviation) * (1 + maxDeviation) / std::pow(1 - maxDeviation, 3);
+	centreLine.radius = std::max(segmentsPerWall * segmentLength / (2 * pi), minRadius);
+	double budget = std::pow(1 - maxDeviation, 3) * centreLine.radius / width - (1 + maxDeviation) * (1 + maxDeviation);
+	double scale = (-(1 + maxDeviation) * sum2 + std::sqrt((1 + maxDeviation) * (1 + maxDeviation) * sum2 * sum2 + 8 * sum1 * sum1 * budget))
+		/ (4 * sum1 * sum1);
+	scale = curvature * std::min(scale, maxDeviation / sum);
+	for (int harmonic = 0; harmonic < numberHarmonics; harmonic++)
+	{
+		centreLine.amplitudes[harmonic] *= scale;
+	}
+
+	double extent = centreLine.radius * (1 + maxDeviation) + width;
+	Vector2 centre = { (float)extent, (float)extent };
+	Map map;
+	map.numberAgents = options.numberAgents;
+	std::vector<Vector2> innerWall;
+	std::vector<Vector2> outerWall;
+	for (int vertex = 0; vertex <= segmentsPerWall; vertex++)
+	{
+		Vector2 point, normal;
+		centreLine.evaluate(2 * pi * (vertex % segmentsPerWall) / segmentsPerWall, centre, point, normal);
+		innerWall.push_back({ (float)(point.x - normal.x * width / 2), (float)(point.y - normal.y * width / 2) });
+		outerWall.push_back({ (float)(point.x + normal.x * width / 2), (float)(point.y + normal.y * width / 2) });
+	}
+	map.mapElements = { innerWall, outerWall };
+
+	Vector2 start, normal;
+	centreLine.evaluate(0, centre, start, normal);
+	map.startingPosition = start;
+	// Facing along the direction of increasing theta, which is the normal turned a quarter turn
+	map.startingAngle = (int)std::lround(std::atan2(normal.x, -normal.y) * 180 / pi);
+	for (int checkPoint = 0; checkPoint < options.numberCheckPoints; checkPoint++)
+	{
+		Vector2 point;
+		centreLine.evaluate(2 * pi * (checkPoint + 0.5) / options.numberCheckPoints, centre, point, normal);
+		map.checkPoints.push_back({ (float)(point.x - normal.x * width / 2), (float)(point.y - normal.y * width / 2) });
+		map.checkPoints.push_back({ (float)(point.x + normal.x * width / 2), (float)(point.y + normal.y * width / 2) });
+	}
+	return map;
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include "Map.h"
+
+/*
+What a generated track looks like. The walls are split evenly between the inner and outer
+sides of the corridor. A curvature of 0 gives a ring and 1 winds the corridor as much as its
+width allows without either side folding over itself
+*/
+struct TrackGeneratorOptions
+{
+	int numberSegments = 1000;
+	float curvature = 0.5f;
+	int numberCheckPoints = 20;
+	float corridorWidth = 80;
+	int numberAgents = 100;
+	uint64_t seed = 0;
+};
+
+Map generateTrack(const TrackGeneratorOptions&);
\ No newline at end of file
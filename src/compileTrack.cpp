@@ -0,0 +1,66 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include "TrackFile.h"
+
+void printUsage()
+{
+	std::cerr << "Usage: compileTrack map-file track-file [--cell-size n]\n";
+}
+
+/*
+Compiles a map file into a track file, which Track::load (and so the --map option) maps
+straight into memory with its grid of walls already built. The map is checked as it's read
+and the track file is read back to check it was written whole
+*/
+int main(int argc, char *argv[])
+{
+	std::string mapPath;
+	std::string trackPath;
+	float wallCellSize = -1;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (option == "--cell-size" && hasValue)
+		{
+			wallCellSize = std::atof(argv[++i]);
+		}
+		else if (option.compare(0, 2, "--") != 0 && mapPath.empty())
+		{
+			mapPath = option;
+		}
+		else if (option.compare(0, 2, "--") != 0 && trackPath.empty())
+		{
+			trackPath = option;
+		}
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+	if (trackPath.empty())
+	{
+		printUsage();
+		return 1;
+	}
+
+	Map map;
+	std::string error;
+	if (!loadMap(mapPath, map, error))
+	{
+		std::cerr << error << '\n';
+		return 1;
+	}
+	Track track(std::move(map), wallCellSize, ScalarIntersection);
+	if (!writeTrackFile(trackPath, track, error) || !readTrackFile(trackPath, ScalarIntersection, error))
+	{
+		std::cerr << error << '\n';
+		return 1;
+	}
+	std::cout << "Compiled " << track.getWalls().getNumberSegments() << " walls into a grid of " << track.getWalls().getNumberCells()
+		<< " cells in " << trackPath << '\n';
+	return 0;
+}
\ No newline at end of file
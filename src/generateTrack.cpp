@@ -0,0 +1,94 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include "TrackFile.h"
+#include "TrackGenerator.h"
+
+void printUsage()
+{
+	std::cerr << "Usage: generateTrack file [--format map|track] [--segments n] [--curvature x] [--check-points n]\n"
+		<< "                     [--width x] [--agents n] [--seed n]\n";
+}
+
+/*
+Generates a closed loop track (see generateTrack) and writes it as a map file or, with the
+track format, as a compiled track file which loads in milliseconds however large it is. The
+same options and seed always give the same track, so benchmarks can be repeated exactly
+*/
+int main(int argc, char *argv[])
+{
+	std::string path;
+	bool compiled = false;
+	TrackGeneratorOptions options;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (option == "--format" && hasValue && (argv[i + 1] == std::string("map") || argv[i + 1] == std::string("track")))
+		{
+			compiled = argv[++i] == std::string("track");
+		}
+		else if (option == "--segments" && hasValue)
+		{
+			options.numberSegments = std::atoi(argv[++i]);
+		}
+		else if (option == "--curvature" && hasValue)
+		{
+			options.curvature = std::atof(argv[++i]);
+		}
+		else if (option == "--check-points" && hasValue)
+		{
+			options.numberCheckPoints = std::atoi(argv[++i]);
+		}
+		else if (option == "--width" && hasValue)
+		{
+			options.corridorWidth = std::atof(argv[++i]);
+		}
+		else if (option == "--agents" && hasValue)
+		{
+			options.numberAgents = std::atoi(argv[++i]);
+		}
+		else if (option == "--seed" && hasValue)
+		{
+			options.seed = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (option.compare(0, 2, "--") != 0 && path.empty())
+		{
+			path = option;
+		}
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+	if (path.empty() || options.numberCheckPoints < 0)
+	{
+		printUsage();
+		return 1;
+	}
+	if (options.numberAgents < minNumberAgents)
+	{
+		std::cerr << "A track needs at least " << minNumberAgents << " agents\n";
+		return 1;
+	}
+
+	Map map = generateTrack(options);
+	std::string error;
+	if (compiled)
+	{
+		Track track(std::move(map), -1, ScalarIntersection);
+		if (!writeTrackFile(path, track, error))
+		{
+			std::cerr << error << '\n';
+			return 1;
+		}
+	}
+	else if (!saveMap(path, map))
+	{
+		std::cerr << "Couldn't write " << path << '\n';
+		return 1;
+	}
+	return 0;
+}
\ No newline at end of file
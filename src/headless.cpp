@@ -0,0 +1,462 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "Coordinator.h"
+#include "IslandModel.h"
+#include "Simulation.h"
+#include "Snapshot.h"
+
+void printUsage()
+{
+	std::cerr << "Usage: headless [--map file]... [--pose x,y,angle]... [--aggregate mean|min] [--generations n] [--threads n]\n"
+		<< "                [--network reference|scalar|avx2|avx512] [--validate-network] [--cell-size n]\n"
+		<< "                [--intersection scalar|avx2|avx512] [--genetics scalar|avx2|avx512] [--step fused|batched]\n"
+		<< "                [--islands n] [--seed n] [--migration-interval n] [--migrants n] [--topology ring|full]\n"
+		<< "                [--workers n] [--batch-size n] [--worker-timeout s] [--steady-state] [--selection truncation|tournament|rank|sus]\n"
+		<< "                [--max-ticks n] [--stall-ticks n] [--laps n] [--diversity exact|sampled]\n"
+		<< "                [--snapshot file] [--snapshot-interval n] [--resume file]\n"
+		<< "                [--telemetry file] [--telemetry-format csv|ndjson]\n";
+}
+
+// A starting pose to evaluate agents from on one of the maps as well as the map's own
+struct PoseOption
+{
+	int map;
+	Vector2 position;
+	int angle;
+};
+
+// Where and how often (in generations) the run is snapshotted, if at all
+struct SnapshotOptions
+{
+	std::string path;
+	int interval = 10;
+};
+
+// Whether to snapshot after the given number of generations of this run, which always snapshots at its end
+bool isSnapshotDue(const SnapshotOptions &options, int generation, int numberGenerations)
+{
+	return !options.path.empty() && ((options.interval > 0 && generation % options.interval == 0) || generation == numberGenerations);
+}
+
+// Carries on a simulation or island model from a snapshot, reporting why if it can't
+template<typename Evolution>
+bool resume(Evolution &evolution, std::string path)
+{
+	SnapshotReader reader;
+	if (!reader.open(path) || !evolution.restoreSnapshot(reader))
+	{
+		std::cerr << "Couldn't resume from " << path << ": " << reader.getError() << '\n';
+		return false;
+	}
+	return true;
+}
+
+// Waits for the last snapshot to be written, reporting if any couldn't be
+void finishSnapshots(SnapshotWriter &writer, const SnapshotOptions &options)
+{
+	if (!writer.wait())
+	{
+		std::cerr << "Couldn't write a snapshot to " << options.path << '\n';
+	}
+}
+
+// Runs the island model, printing the statistics of every island each generation
+void runIslands(IslandModel &islandModel, int numberGenerations, const SnapshotOptions &snapshotOptions)
+{
+	SnapshotWriter snapshotWriter;
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	for (int generation = 0; numberGenerations == 0 || generation < numberGenerations; generation++)
+	{
+		std::vector<GenerationStatistics> statistics = islandModel.runGeneration();
+		for (int island = 0; island < (int)statistics.size(); island++)
+		{
+			std::cout << "Island " << island << "; ";
+			printStatistics(statistics[island]);
+		}
+		if (isSnapshotDue(snapshotOptions, generation + 1, numberGenerations))
+		{
+			islandModel.saveSnapshot(snapshotWriter, snapshotOptions.path);
+		}
+	}
+	finishSnapshots(snapshotWriter, snapshotOptions);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+	std::cout << numberGenerations << " generations of " << islandModel.getNumberIslands() << " islands in " << elapsed.count() << "s ("
+		<< numberGenerations * islandModel.getNumberIslands() / elapsed.count() << " island generations/s)\n";
+}
+
+#if DISTRIBUTED_EVALUATION
+// Runs the simulation with every generation evaluated by the coordinator's workers
+void runDistributed(Coordinator &coordinator, Simulation &simulation, int numberGenerations, const SnapshotOptions &snapshotOptions)
+{
+	SnapshotWriter snapshotWriter;
+	std::vector<float> caseFitness;
+	std::vector<float> fitnesses;
+	int numberCases = simulation.getEvaluationCases().size();
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	for (int generation = 0; numberGenerations == 0 || generation < numberGenerations; generation++)
+	{
+		const Population &population = simulation.getPopulation();
+		caseFitness.resize((size_t)numberCases * population.size());
+		fitnesses.resize(population.size());
+		for (int evaluationCase = 0; evaluationCase < numberCases; evaluationCase++)
+		{
+			coordinator.evaluate(evaluationCase, simulation.getTerminationPolicy(), population.getGenome(0), population.genomeStride,
+				population.size(), caseFitness.data() + (size_t)evaluationCase * population.size());
+		}
+		aggregateFitness(simulation.getFitnessAggregation(), caseFitness.data(), numberCases, population.size(), fitnesses.data());
+		simulation.completeGeneration(fitnesses);
+		printStatistics(simulation.nextGeneration());
+		if (isSnapshotDue(snapshotOptions, generation + 1, numberGenerations))
+		{
+			simulation.saveSnapshot(snapshotWriter, snapshotOptions.path);
+		}
+	}
+	finishSnapshots(snapshotWriter, snapshotOptions);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+	std::cout << numberGenerations << " generations on " << coordinator.getNumberWorkers() << " workers in " << elapsed.count() << "s ("
+		<< numberGenerations / elapsed.count() << " generations/s, " << coordinator.getNumberRestarts() << " restarts)\n";
+}
+#endif
+
+/*
+Headless runner which evolves the population at full CPU speed without opening a window, for
+use on batch and CI machines. Given more than one map or extra starting poses, every genome
+is scored on each map from its own pose and each extra pose given after it, and its fitnesses
+are combined by their mean (the default) or minimum. The first map sets the size of the
+population. A number of generations of 0 (the default) runs until the process is killed and a
+number of threads of 0 (the default) uses every hardware thread. The network, intersection
+and genetics kernels default to the fastest ones the CPU supports and the cell size of the
+grid of walls is chosen from the map unless given (0 tests every wall). Agents are stepped
+with the fused step unless the batched step is asked for, which is the only one using the
+network kernels, so validating the network implies the batched step. Every random number
+comes from streams derived from the seed (0 by default), so the same seed gives the same run
+whatever the number of threads. Given a number of islands it runs the island model instead,
+with each island the size of the map's population. Given a number of workers (on POSIX
+systems) the agents are evaluated by that many worker processes in batches of the given size,
+replacing a worker which takes longer than the timeout (300 seconds by default, 0 for none)
+over a batch. Parents are picked by truncation unless another selection strategy is given and
+diversity is measured exactly unless sampling is asked for. The steady state genetic
+algorithm reports its statistics for every population's worth of agents evaluated in place of
+each generation. Agents can be stopped early after a number of ticks, after a number of ticks
+without reaching a new check point or after a number of laps. Given a snapshot file the run
+is snapshotted every few generations (10 by default) and at its end, and a run resumed from a
+snapshot carries on exactly as it would have, given the same options
+*/
+int main(int argc, char *argv[])
+{
+	const std::string defaultMapPath = "resources/map.txt";
+	std::vector<std::string> mapPaths;
+	std::vector<PoseOption> poses;
+	FitnessAggregation fitnessAggregation = MeanFitness;
+	int numberGenerations = 0;
+	int numberThreads = 0;
+	NetworkKernel networkKernel = bestNetworkKernel();
+	bool validateNetwork = false;
+	float wallCellSize = -1;
+	IntersectionKernel intersectionKernel = bestIntersectionKernel();
+	GeneticsKernel geneticsKernel = bestGeneticsKernel();
+	SelectionStrategy selectionStrategy = TruncationSelection;
+	DiversityMode diversityMode = ExactDiversity;
+	SnapshotOptions snapshotOptions;
+	std::string resumePath;
+	std::string telemetryPath;
+	TelemetryFormat telemetryFormat = NdjsonTelemetry;
+	bool fusedStep = true;
+	int numberIslands = 0;
+	uint64_t seed = 0;
+	int migrationInterval = 10;
+	int numberMigrants = 2;
+	MigrationTopology topology = RingTopology;
+	int numberWorkers = 0;
+	int batchSize = 64;
+	double workerTimeout = 300;
+	bool steadyState = false;
+	TerminationPolicy terminationPolicy;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		bool hasValue = i + 1 < argc;
+		PoseOption pose;
+		if (option == "--map" && hasValue)
+		{
+			mapPaths.push_back(argv[++i]);
+		}
+		else if (option == "--pose" && hasValue && std::sscanf(argv[i + 1], "%f,%f,%d", &pose.position.x, &pose.position.y, &pose.angle) == 3)
+		{
+			i++;
+			if (mapPaths.empty())
+			{
+				mapPaths.push_back(defaultMapPath);
+			}
+			pose.map = mapPaths.size() - 1;
+			poses.push_back(pose);
+		}
+		else if (option == "--aggregate" && hasValue && parseFitnessAggregation(argv[i + 1], fitnessAggregation))
+		{
+			i++;
+		}
+		else if (option == "--generations" && hasValue)
+		{
+			numberGenerations = std::atoi(argv[++i]);
+		}
+		else if (option == "--threads" && hasValue)
+		{
+			numberThreads = std::atoi(argv[++i]);
+		}
+		else if (option == "--network" && hasValue && parseNetworkKernel(argv[i + 1], networkKernel))
+		{
+			i++;
+			if (!isNetworkKernelSupported(networkKernel))
+			{
+				std::cerr << "The " << getNetworkKernelName(networkKernel) << " kernel isn't supported by this CPU\n";
+				return 1;
+			}
+		}
+		else if (option == "--intersection" && hasValue && parseIntersectionKernel(argv[i + 1], intersectionKernel))
+		{
+			i++;
+			if (!isIntersectionKernelSupported(intersectionKernel))
+			{
+				std::cerr << "The " << getIntersectionKernelName(intersectionKernel) << " kernel isn't supported by this CPU\n";
+				return 1;
+			}
+		}
+		else if (option == "--genetics" && hasValue && parseGeneticsKernel(argv[i + 1], geneticsKernel))
+		{
+			i++;
+			if (!isGeneticsKernelSupported(geneticsKernel))
+			{
+				std::cerr << "The " << getGeneticsKernelName(geneticsKernel) << " kernel isn't supported by this CPU\n";
+				return 1;
+			}
+		}
+		else if (option == "--cell-size" && hasValue)
+		{
+			wallCellSize = std::atof(argv[++i]);
+		}
+		else if (option == "--step" && hasValue && (argv[i + 1] == std::string("fused") || argv[i + 1] == std::string("batched")))
+		{
+			fusedStep = argv[++i] == std::string("fused");
+		}
+		else if (option == "--islands" && hasValue)
+		{
+			numberIslands = std::atoi(argv[++i]);
+		}
+		else if (option == "--seed" && hasValue)
+		{
+			seed = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (option == "--migration-interval" && hasValue)
+		{
+			migrationInterval = std::atoi(argv[++i]);
+		}
+		else if (option == "--migrants" && hasValue)
+		{
+			numberMigrants = std::atoi(argv[++i]);
+		}
+		else if (option == "--topology" && hasValue && parseMigrationTopology(argv[i + 1], topology))
+		{
+			i++;
+		}
+		else if (option == "--workers" && hasValue && DISTRIBUTED_EVALUATION)
+		{
+			numberWorkers = std::atoi(argv[++i]);
+		}
+		else if (option == "--batch-size" && hasValue)
+		{
+			batchSize = std::atoi(argv[++i]);
+		}
+		else if (option == "--worker-timeout" && hasValue)
+		{
+			workerTimeout = std::atof(argv[++i]);
+		}
+		else if (option == "--selection" && hasValue && parseSelectionStrategy(argv[i + 1], selectionStrategy))
+		{
+			i++;
+		}
+		else if (option == "--diversity" && hasValue && parseDiversityMode(argv[i + 1], diversityMode))
+		{
+			i++;
+		}
+		else if (option == "--snapshot" && hasValue)
+		{
+			snapshotOptions.path = argv[++i];
+		}
+		else if (option == "--snapshot-interval" && hasValue)
+		{
+			snapshotOptions.interval = std::atoi(argv[++i]);
+		}
+		else if (option == "--resume" && hasValue)
+		{
+			resumePath = argv[++i];
+		}
+		else if (option == "--telemetry" && hasValue)
+		{
+			telemetryPath = argv[++i];
+		}
+		else if (option == "--telemetry-format" && hasValue && parseTelemetryFormat(argv[i + 1], telemetryFormat))
+		{
+			i++;
+		}
+		else if (option == "--steady-state")
+		{
+			steadyState = true;
+		}
+		else if (option == "--max-ticks" && hasValue)
+		{
+			terminationPolicy.maxTicks = std::atoi(argv[++i]);
+		}
+		else if (option == "--stall-ticks" && hasValue)
+		{
+			terminationPolicy.stallTicks = std::atoi(argv[++i]);
+		}
+		else if (option == "--laps" && hasValue)
+		{
+			terminationPolicy.laps = std::atoi(argv[++i]);
+		}
+		else if (option == "--validate-network")
+		{
+			validateNetwork = true;
+		}
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (mapPaths.empty())
+	{
+		mapPaths.push_back(defaultMapPath);
+	}
+	// Each map's cases are kept together so a track's walls stay in cache while it's evaluated
+	std::vector<EvaluationCase> evaluationCases;
+	for (int map = 0; map < (int)mapPaths.size(); map++)
+	{
+		std::string error;
+		std::shared_ptr<const Track> mapTrack = Track::load(mapPaths[map], error, wallCellSize, intersectionKernel);
+		if (!mapTrack)
+		{
+			std::cerr << error << '\n';
+			return 1;
+		}
+		evaluationCases.push_back(makeEvaluationCase(mapTrack));
+		for (const PoseOption &pose : poses)
+		{
+			if (pose.map == map)
+			{
+				evaluationCases.push_back({ mapTrack, pose.position, pose.angle });
+			}
+		}
+	}
+	if (steadyState && evaluationCases.size() > 1)
+	{
+		std::cerr << "The steady state mode only runs on one map from one pose\n";
+		return 1;
+	}
+	if (!telemetryPath.empty() && (numberIslands > 0 || numberWorkers > 0))
+	{
+		std::cerr << "Telemetry is only recorded for a single population run on this process\n";
+		return 1;
+	}
+	std::shared_ptr<const Track> track = evaluationCases[0].track;
+	if (numberIslands > 0)
+	{
+		IslandModel islandModel(track, numberIslands, seed, numberThreads);
+		islandModel.setMigration(migrationInterval, numberMigrants, topology);
+		for (int island = 0; island < numberIslands; island++)
+		{
+			islandModel.getIsland(island).setNetworkKernel(networkKernel);
+			islandModel.getIsland(island).setFusedStep(fusedStep);
+			islandModel.getIsland(island).setGeneticsKernel(geneticsKernel);
+			islandModel.getIsland(island).setSelectionStrategy(selectionStrategy);
+			islandModel.getIsland(island).setDiversityMode(diversityMode);
+			islandModel.getIsland(island).setTerminationPolicy(terminationPolicy);
+			islandModel.getIsland(island).setEvaluationCases(evaluationCases, fitnessAggregation);
+		}
+		if (!resumePath.empty() && !resume(islandModel, resumePath))
+		{
+			return 1;
+		}
+		runIslands(islandModel, numberGenerations, snapshotOptions);
+		return 0;
+	}
+#if DISTRIBUTED_EVALUATION
+	if (numberWorkers > 0 && (batchSize < 1 || batchSize > maxBatchSize))
+	{
+		std::cerr << "The batch size must be between 1 and " << maxBatchSize << '\n';
+		return 1;
+	}
+	if (numberWorkers > 0)
+	{
+		// Workers are forked so the coordinator's simulation mustn't start any threads
+		Coordinator coordinator(evaluationCases, numberWorkers, batchSize);
+		coordinator.setBatchTimeout(workerTimeout);
+		Simulation simulation(track, 1, Random(seed));
+		simulation.setEvaluationCases(evaluationCases, fitnessAggregation);
+		simulation.setGeneticsKernel(geneticsKernel);
+		simulation.setSelectionStrategy(selectionStrategy);
+		simulation.setDiversityMode(diversityMode);
+		simulation.setTerminationPolicy(terminationPolicy);
+		if (!resumePath.empty() && !resume(simulation, resumePath))
+		{
+			return 1;
+		}
+		runDistributed(coordinator, simulation, numberGenerations, snapshotOptions);
+		return 0;
+	}
+#endif
+	Simulation simulation(track, numberThreads, Random(seed));
+	simulation.setNetworkKernel(networkKernel, validateNetwork);
+	simulation.setFusedStep(fusedStep && !validateNetwork);
+	simulation.setGeneticsKernel(geneticsKernel);
+	simulation.setSelectionStrategy(selectionStrategy);
+	simulation.setDiversityMode(diversityMode);
+	simulation.setTerminationPolicy(terminationPolicy);
+	simulation.setEvaluationCases(evaluationCases, fitnessAggregation);
+	if (!resumePath.empty() && !resume(simulation, resumePath))
+	{
+		return 1;
+	}
+	SnapshotWriter snapshotWriter;
+	TelemetryWriter telemetryWriter;
+	if (!telemetryPath.empty())
+	{
+		if (!telemetryWriter.open(telemetryPath, telemetryFormat))
+		{
+			std::cerr << "Couldn't create the telemetry file " << telemetryPath << '\n';
+			return 1;
+		}
+		simulation.setTelemetry(true);
+	}
+	// A resumed run only counts the evaluations it makes itself
+	long long startEvaluations = simulation.getNumberEvaluations();
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	for (int generation = 0; numberGenerations == 0 || generation < numberGenerations; generation++)
+	{
+		GenerationStatistics statistics = steadyState ? simulation.runSteadyState(simulation.getPopulation().size()) : simulation.runGeneration();
+		printStatistics(statistics);
+		telemetryWriter.write(statistics, simulation.getGenerationTelemetry());
+		if (isSnapshotDue(snapshotOptions, generation + 1, numberGenerations))
+		{
+			simulation.saveSnapshot(snapshotWriter, snapshotOptions.path);
+		}
+	}
+	finishSnapshots(snapshotWriter, snapshotOptions);
+	if (!telemetryWriter.close())
+	{
+		std::cerr << "Couldn't write the telemetry to " << telemetryPath << '\n';
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+	std::cout << numberGenerations << " generations in " << elapsed.count() << "s ("
+		<< numberGenerations / elapsed.count() << " generations/s, " << (simulation.getNumberEvaluations() - startEvaluations) / elapsed.count()
+		<< " evaluations/s)\n";
+	if (validateNetwork)
+	{
+		std::cout << "Network decisions differing from the reference kernel: " << simulation.getNetworkMismatches() << '\n';
+	}
+	return 0;
+}
\ No newline at end of file